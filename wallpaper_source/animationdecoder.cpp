@@ -0,0 +1,126 @@
+#include "animationdecoder.h"
+
+#include <QtConcurrent>
+
+#include "animationsource.h"
+#include "imageresampler.h"
+
+AnimationDecoder::AnimationDecoder(int queueDepth, QObject *parent) : QObject(parent), m_queue(queueDepth)
+{
+}
+
+AnimationDecoder::~AnimationDecoder()
+{
+    stop();
+}
+
+void AnimationDecoder::start(const QString &path, const QSize &size, qreal devicePixelRatio, int firstFrame)
+{
+    stop();
+
+    m_cancel = std::make_shared<QAtomicInt>(0);
+    const int generation = ++m_generation;
+    const std::shared_ptr<QAtomicInt> cancel = m_cancel;
+
+    m_decode = QtConcurrent::run([=](){
+        decodeLoop(path, size, devicePixelRatio, firstFrame, generation, cancel);
+    });
+}
+
+void AnimationDecoder::stop()
+{
+    if (m_cancel)
+        m_cancel->storeRelease(1);
+
+    ++m_generation;
+
+    // 关闭队列唤醒正在等待空位的解码线程
+    m_queue.close();
+    m_decode.waitForFinished();
+    m_queue.reset();
+    m_cancel.reset();
+}
+
+bool AnimationDecoder::isRunning() const
+{
+    return m_decode.isRunning();
+}
+
+bool AnimationDecoder::takeFrame(FrameQueue::Frame *frame)
+{
+    return m_queue.tryPop(frame);
+}
+
+bool AnimationDecoder::nextTimestamp(qint64 *timestamp) const
+{
+    return m_queue.peekTimestamp(timestamp);
+}
+
+int AnimationDecoder::queueDepth() const
+{
+    return m_queue.count();
+}
+
+int AnimationDecoder::queueCapacity() const
+{
+    return m_queue.capacity();
+}
+
+void AnimationDecoder::decodeLoop(const QString &path, const QSize &size, qreal devicePixelRatio, int firstFrame,
+                                  int generation, std::shared_ptr<QAtomicInt> cancel)
+{
+    std::unique_ptr<AnimationSource> source = AnimationSource::create(path);
+    QImage previous;
+    qint64 timestamp = 0;
+    int frames = 0;                             // 本轮已解码的帧数
+
+    if (!source)
+        return;
+
+    // 从指定帧开始，不支持跳转的格式逐帧读过
+    if (firstFrame > 0)
+        source->skip(firstFrame);
+
+    while (cancel->loadAcquire() == 0)
+    {
+        QImage frame = source->read();
+        if (frame.isNull())
+        {
+            // 完整的一轮不足两帧时没有后续变化，否则从头循环
+            if (frames < 2 && firstFrame == 0)
+                break;
+
+            if (!source->rewind())
+                break;
+
+            frame = source->read();
+            if (frame.isNull())
+                break;
+
+            frames = 0;
+            firstFrame = 0;
+        }
+
+        ++frames;
+        const int delay = AnimationSource::clampDelay(source->nextDelay());
+
+        if (frame.format() != QImage::Format_ARGB32_Premultiplied)
+            frame = frame.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        if (size.isValid() && frame.size() != size)
+            frame = ImageResampler::scaled(frame, size);
+        frame.setDevicePixelRatio(devicePixelRatio);
+
+        const FrameQueue::Frame queued = { FrameStore::diff(previous, frame, delay), timestamp };
+        previous = frame;
+        timestamp += delay;
+
+        // 队列满时在此等待，界面线程取走一帧后继续
+        if (!m_queue.push(queued))
+            break;
+
+        QMetaObject::invokeMethod(this, [=](){
+            if (generation == m_generation)
+                emit frameQueued();
+        }, Qt::QueuedConnection);
+    }
+}
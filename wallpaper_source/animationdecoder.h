@@ -0,0 +1,46 @@
+#ifndef ANIMATIONDECODER_H
+#define ANIMATIONDECODER_H
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QObject>
+#include <QSize>
+#include <QString>
+
+#include <memory>
+
+#include "framequeue.h"
+
+// 动画逐帧解码：在工作线程中循环解码、缩放到屏幕尺寸并求帧间变化，附带显示时刻放入有界队列
+class AnimationDecoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AnimationDecoder(int queueDepth = 4, QObject *parent = nullptr);
+    ~AnimationDecoder();
+
+    void start(const QString &path, const QSize &size, qreal devicePixelRatio, int firstFrame = 0);
+    void stop();
+    bool isRunning() const;
+
+    bool takeFrame(FrameQueue::Frame *frame);
+    bool nextTimestamp(qint64 *timestamp) const;
+    int queueDepth() const;
+    int queueCapacity() const;
+
+signals:
+    void frameQueued();
+
+private:
+    void decodeLoop(const QString &path, const QSize &size, qreal devicePixelRatio, int firstFrame,
+                    int generation, std::shared_ptr<QAtomicInt> cancel);
+
+private:
+    FrameQueue m_queue;
+    QFuture<void> m_decode;
+    std::shared_ptr<QAtomicInt> m_cancel;
+    int m_generation = 0;                       // 作废已排队的通知
+};
+
+#endif // ANIMATIONDECODER_H
@@ -0,0 +1,569 @@
+#include "animationplayer.h"
+
+#include <QtConcurrent>
+
+#include "animationsource.h"
+#include "imageresampler.h"
+#include "palettecodec.h"
+
+namespace
+{
+// 晚于显示时刻超过该值才计为晚到的帧，毫秒
+const int LateTolerance = 10;
+
+// 落后超过该值时不再跳帧追赶，直接从当前时刻重新计时，毫秒
+const int MaxCatchUp = 1000;
+
+// 压缩了这么多帧之后才比较展开与解码的耗时
+const int MinPackedSamples = 4;
+}
+
+AnimationPlayer::AnimationPlayer(QObject *parent) : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+
+    connect(&m_timer, &QTimer::timeout, this, &AnimationPlayer::onTick);
+    connect(m_pDecoder, &AnimationDecoder::frameQueued, this, &AnimationPlayer::onFrameQueued);
+
+    MemoryBudget::instance()->registerConsumer(this);
+}
+
+AnimationPlayer::~AnimationPlayer()
+{
+    stop();
+
+    MemoryBudget::instance()->unregisterConsumer(this);
+}
+
+bool AnimationPlayer::start(const QString &path, const QSize &size, qreal devicePixelRatio)
+{
+    stop();
+
+    // 只检查文件头，容器的解析留给工作线程
+    if (!AnimationSource::supports(MediaRegistry::sniff(path)))
+        return false;
+
+    m_path = path;
+    m_size = size;
+    m_devicePixelRatio = devicePixelRatio;
+    m_running = true;
+    m_waiting = true;
+    m_statistics = { 0, 0, 0, 0, 0, 0, true, 0, 0.0, 0 };
+    m_jitter.clear();
+    m_expandNs = 0;
+    m_expanded = 0;
+
+    // 帧缓存可用的内存，第一轮解码时据此决定是否压缩存储
+    const qint64 allowance = MemoryBudget::instance()->available();
+
+    m_cancel = std::make_shared<QAtomicInt>(0);
+    const int generation = ++m_generation;
+    const std::shared_ptr<QAtomicInt> cancel = m_cancel;
+
+    m_decode = QtConcurrent::run([=](){
+        decodeAll(path, size, devicePixelRatio, allowance, generation, cancel);
+    });
+
+    return true;
+}
+
+void AnimationPlayer::stop()
+{
+    m_timer.stop();
+    cancelDecode();
+    m_decode.waitForFinished();
+    m_pDecoder->stop();
+
+    m_store.clear();
+    m_canvas = QImage();
+    m_clock.invalidate();
+    m_clockOffset = 0;
+    m_due         = 0;
+    m_queueBase   = 0;
+    m_index     = -1;
+    m_waiting   = false;
+    m_streaming = false;
+    m_paused    = false;
+    m_running   = false;
+}
+
+void AnimationPlayer::setPaused(bool paused)
+{
+    if (paused == m_paused)
+        return;
+
+    m_paused = paused;
+
+    // 第一轮的解码不受暂停影响；暂停期间播放时钟停止，恢复后从暂停的帧继续，不补播暂停期间的帧
+    if (paused)
+    {
+        m_timer.stop();
+
+        if (m_clock.isValid())
+        {
+            m_clockOffset = position();
+            m_clock.invalidate();
+        }
+    }
+    else
+    {
+        m_clock.start();
+
+        if (m_running && !m_waiting)
+            onTick();
+    }
+}
+
+bool AnimationPlayer::isPaused() const
+{
+    return m_paused;
+}
+
+bool AnimationPlayer::isRunning() const
+{
+    return m_running;
+}
+
+const JitterHistogram &AnimationPlayer::jitter() const
+{
+    return m_jitter;
+}
+
+AnimationPlayer::Statistics AnimationPlayer::statistics() const
+{
+    Statistics statistics = m_statistics;
+    statistics.queueDepth = m_pDecoder->queueDepth();
+    statistics.queueCapacity = m_pDecoder->queueCapacity();
+    statistics.storeBytes = m_store.sizeInBytes();
+    statistics.stored = !m_streaming;
+    statistics.expandMs = m_expanded > 0 ? m_expandNs / 1e6 / m_expanded : 0.0;
+
+    return statistics;
+}
+
+QString AnimationPlayer::memoryName() const
+{
+    return QStringLiteral("animation");
+}
+
+qint64 AnimationPlayer::memoryUsage() const
+{
+    return m_store.sizeInBytes();
+}
+
+int AnimationPlayer::memoryPriority() const
+{
+    return CachePriority;
+}
+
+qint64 AnimationPlayer::releaseMemory(qint64 bytes)
+{
+    Q_UNUSED(bytes)
+
+    // 帧缓存只能整体放弃，之后改为逐帧解码
+    if (m_streaming || m_store.isEmpty())
+        return 0;
+
+    const qint64 released = m_store.sizeInBytes();
+    fallBackToQueue();
+
+    return released;
+}
+
+void AnimationPlayer::onTick()
+{
+    // 暂停时仍然显示第一帧，壁纸切换不必等到恢复
+    if (m_paused && m_index >= 0)
+        return;
+
+    qint64 due = 0;
+    if (!nextDue(&due))
+    {
+        waitForFrame();
+        return;
+    }
+
+    // 第一帧立即显示，播放时钟从此开始
+    if (m_index < 0)
+    {
+        m_clockOffset = 0;
+        if (m_paused)
+            m_clock.invalidate();
+        else
+            m_clock.start();
+
+        advance(0);
+        m_statistics.framesPresented++;
+        scheduleNext();
+        return;
+    }
+
+    // 定时器提前触发时等到显示时刻
+    const qint64 now = position();
+    if (due > now)
+    {
+        scheduleAt(due);
+        return;
+    }
+
+    // 已经到时的帧全部拷贝到壁纸缓冲，只有最后一帧算作显示，其余计为跳过；落后太多时不再追赶
+    const bool catchUp = now - due <= MaxCatchUp * 1000;
+    int applied = 0;
+    do
+    {
+        advance(due);
+        ++applied;
+    } while (catchUp && nextDue(&due) && due <= now);
+
+    const qint64 jitter = now - m_due;
+    m_jitter.add(jitter);
+    m_statistics.framesPresented++;
+    m_statistics.framesSkipped += applied - 1;
+
+    // 晚到且无帧可跳（解码跟不上或放弃追赶）时从实际显示时刻重新计时，之后的帧不会连续补播
+    if (jitter > LateTolerance * 1000)
+    {
+        m_statistics.framesLate++;
+
+        qint64 next = 0;
+        if (!catchUp || !nextDue(&next))
+            m_clockOffset -= jitter;
+    }
+
+    scheduleNext();
+}
+
+bool AnimationPlayer::nextDue(qint64 *due) const
+{
+    if (m_streaming)
+    {
+        qint64 timestamp = 0;
+        if (!m_pDecoder->nextTimestamp(&timestamp))
+            return false;
+
+        *due = m_queueBase + timestamp * 1000;
+        return true;
+    }
+
+    // 第一轮还没解码到下一帧，或者单帧图片没有后续变化
+    if (m_index + 1 >= m_store.count() && !(m_store.isComplete() && m_store.count() > 1))
+        return false;
+
+    *due = m_index < 0 ? 0 : m_due + qint64(m_store.at(m_index).delay) * 1000;
+    return true;
+}
+
+void AnimationPlayer::advance(qint64 due)
+{
+    if (m_streaming)
+    {
+        FrameQueue::Frame frame;
+        m_pDecoder->takeFrame(&frame);
+
+        m_index++;
+        present(frame.delta);
+    }
+    else if (m_index + 1 < m_store.count())
+    {
+        m_index++;
+        present(m_store.at(m_index));
+    }
+    else
+    {
+        // 壁纸始终循环播放，最后一帧经循环差异回到第一帧
+        m_index = 0;
+        present(m_store.loopDelta());
+    }
+
+    m_due = due;
+}
+
+void AnimationPlayer::waitForFrame()
+{
+    // 帧队列与未完成的帧缓存会在解码出下一帧后继续
+    m_waiting = m_streaming || !m_store.isComplete();
+}
+
+void AnimationPlayer::scheduleNext()
+{
+    qint64 due = 0;
+    if (nextDue(&due))
+        scheduleAt(due);
+    else
+        waitForFrame();
+}
+
+void AnimationPlayer::scheduleAt(qint64 due)
+{
+    // 向上取整到毫秒，PreciseTimer 不会早于到时时刻触发
+    if (!m_paused)
+        m_timer.start(int(qMax<qint64>(0, (due - position() + 999) / 1000)));
+}
+
+void AnimationPlayer::onFrameQueued()
+{
+    m_statistics.framesDecoded++;
+
+    if (m_streaming && m_waiting)
+    {
+        m_waiting = false;
+        onTick();
+    }
+}
+
+qint64 AnimationPlayer::position() const
+{
+    return m_clockOffset + (m_clock.isValid() ? m_clock.nsecsElapsed() / 1000 : 0);
+}
+
+void AnimationPlayer::decodeAll(const QString &path, const QSize &size, qreal devicePixelRatio, qint64 allowance,
+                                int generation, std::shared_ptr<QAtomicInt> cancel)
+{
+    // 工作线程：逐帧解码、缩放到屏幕尺寸并与上一帧比较，只把变化区域交给界面线程
+    std::unique_ptr<AnimationSource> source = AnimationSource::create(path);
+    const int frameCount = source ? source->frameCount() : -1;
+    QImage first;
+    QImage previous;
+    QImage firstSource;
+    QImage packedBase;                          // 上一帧压缩存储时为其源图，否则为空，下一个压缩帧保存整帧
+    bool firstPacked = false;
+    QElapsedTimer timer;
+    qint64 rawBytes = 0;
+    qint64 decodeNs = 0;
+    qint64 expandNs = 0;
+    int frames = 0;
+    int packedFrames = 0;
+    bool compress = false;
+
+    while (source && cancel->loadAcquire() == 0)
+    {
+        timer.start();
+
+        QImage frame = source->read();
+        if (frame.isNull())
+            break;
+
+        const int delay = AnimationSource::clampDelay(source->nextDelay());
+
+        if (frame.format() != QImage::Format_ARGB32_Premultiplied)
+            frame = frame.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        // 源分辨率的帧留给压缩存储使用，无需缩放时与屏幕尺寸的帧共用数据
+        QImage original;
+        if (size.isValid() && frame.size() != size)
+        {
+            original = frame;
+            frame = ImageResampler::scaled(frame, size);
+        }
+        frame.setDevicePixelRatio(devicePixelRatio);
+        if (original.isNull())
+            original = frame;
+
+        FrameStore::Delta delta = FrameStore::diff(previous, frame, delay);
+
+        const bool isFirst = first.isNull();
+        if (isFirst)
+        {
+            first = frame;
+            firstSource = original;
+        }
+        previous = frame;
+
+        decodeNs += timer.nsecsElapsed();
+        rawBytes += delta.patch.sizeInBytes();
+        ++frames;
+
+        // 按已解码帧的平均大小估算整个动画，超出可用内存时之后的帧改为压缩存储
+        if (!compress && rawBytes / frames * qMax(frames, frameCount) > allowance)
+            compress = true;
+
+        // 缩放后的帧颜色往往远超 256 种，压缩的是源分辨率的变化区域
+        if (compress && pack(&delta, packedBase, original, frame.size(), &expandNs))
+        {
+            packedBase = original;
+            firstPacked = firstPacked || isFirst;
+            if (!delta.packed.isEmpty())
+                ++packedFrames;
+        }
+        else
+        {
+            packedBase = QImage();
+        }
+
+        // 展开比重新解码还慢时压缩没有意义，改为由解码线程逐帧解码
+        if (packedFrames >= MinPackedSamples && expandNs > decodeNs / frames * packedFrames)
+        {
+            QMetaObject::invokeMethod(this, [=](){
+                onPackingTooSlow(generation);
+            }, Qt::QueuedConnection);
+            return;
+        }
+
+        QMetaObject::invokeMethod(this, [=](){
+            onDeltaDecoded(generation, delta);
+        }, Qt::QueuedConnection);
+    }
+
+    if (cancel->loadAcquire() != 0)
+        return;
+
+    if (first.isNull())
+    {
+        QMetaObject::invokeMethod(this, [=](){
+            onDecodeFailed(generation);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // 第一帧压缩存储时，之后的压缩帧依赖画布上的第一帧，循环差异无法压缩时改为保存整帧
+    FrameStore::Delta loop = FrameStore::diff(previous, first, 0);
+    if (compress && !pack(&loop, packedBase, firstSource, first.size(), &expandNs) && firstPacked)
+        pack(&loop, QImage(), firstSource, first.size(), &expandNs);
+
+    QMetaObject::invokeMethod(this, [=](){
+        onDecodeFinished(generation, loop);
+    }, Qt::QueuedConnection);
+}
+
+void AnimationPlayer::onDeltaDecoded(int generation, const FrameStore::Delta &delta)
+{
+    if (generation != m_generation || m_streaming)
+        return;
+
+    m_statistics.framesDecoded++;
+
+    // 预算不足时可能先淘汰自身的帧缓存，此时已经改为逐帧解码
+    if (!MemoryBudget::instance()->reserve(delta.sizeInBytes(), this) || m_streaming)
+    {
+        if (!m_streaming)
+            fallBackToQueue();
+        return;
+    }
+
+    if (!delta.packed.isEmpty())
+        m_statistics.compressedFrames++;
+
+    m_store.append(delta);
+
+    if (m_waiting)
+    {
+        m_waiting = false;
+        onTick();
+    }
+}
+
+void AnimationPlayer::onDecodeFinished(int generation, const FrameStore::Delta &loop)
+{
+    if (generation != m_generation || m_streaming)
+        return;
+
+    MemoryBudget::instance()->reserve(loop.sizeInBytes(), this);
+    m_store.setLoopDelta(loop);
+
+    if (m_waiting)
+    {
+        m_waiting = false;
+        onTick();
+    }
+}
+
+void AnimationPlayer::onPackingTooSlow(int generation)
+{
+    if (generation == m_generation && !m_streaming)
+        fallBackToQueue();
+}
+
+void AnimationPlayer::onDecodeFailed(int generation)
+{
+    if (generation != m_generation)
+        return;
+
+    m_running = false;
+    m_waiting = false;
+    emit failed();
+}
+
+void AnimationPlayer::present(const FrameStore::Delta &delta)
+{
+    if (delta.rect.isEmpty())
+        return;
+
+    if (delta.packed.isEmpty())
+    {
+        emit patchReady(delta.patch, delta.rect.topLeft());
+        return;
+    }
+
+    // 压缩存储的帧展开到源分辨率的画布，再缩放出变化区域到复用的临时图片，壁纸窗口随即拷贝
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!FrameStore::expand(delta, m_size, &m_canvas, &m_scratch))
+        return;
+
+    m_expandNs += timer.nsecsElapsed();
+    m_expanded++;
+
+    emit patchReady(m_scratch, delta.rect.topLeft());
+}
+
+bool AnimationPlayer::pack(FrameStore::Delta *delta, const QImage &previous, const QImage &current,
+                           const QSize &size, qint64 *expandNs)
+{
+    FrameStore::Delta packed = *delta;
+    if (!FrameStore::pack(&packed, previous, current, size))
+        return false;
+
+    if (packed.packed.isEmpty())
+    {
+        *delta = packed;
+        return true;
+    }
+
+    // 试展开一次，解出的像素必须与源图的变化区域完全一致，否则不压缩这一帧
+    QElapsedTimer timer;
+    timer.start();
+
+    QImage expanded;
+    if (!PaletteCodec::unpack(packed.packed, &expanded))
+        return false;
+
+    const qint64 unpackNs = timer.nsecsElapsed();
+
+    if (expanded != current.copy(packed.source).convertToFormat(QImage::Format_ARGB32_Premultiplied))
+        return false;
+
+    // 校验通过后当前源图即是展开后的画布，在它上面测量缩放的耗时，比较的时间不计入
+    timer.restart();
+    if (ImageResampler::scaledRect(current, size, packed.rect).isNull())
+        return false;
+
+    *expandNs += unpackNs + timer.nsecsElapsed();
+    *delta = packed;
+
+    return true;
+}
+
+void AnimationPlayer::fallBackToQueue()
+{
+    // 解码线程从下一帧开始，其时间戳接续帧缓存的时间线
+    m_queueBase = m_index >= 0 ? m_due + qint64(m_store.at(m_index).delay) * 1000 : 0;
+
+    cancelDecode();
+    m_timer.stop();
+
+    m_store.clear();
+    m_canvas = QImage();
+    m_streaming = true;
+    m_waiting = true;
+
+    m_pDecoder->start(m_path, m_size, m_devicePixelRatio, m_index + 1);
+}
+
+void AnimationPlayer::cancelDecode()
+{
+    if (m_cancel)
+        m_cancel->storeRelease(1);
+
+    ++m_generation;
+}
@@ -0,0 +1,120 @@
+#ifndef ANIMATIONPLAYER_H
+#define ANIMATIONPLAYER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QImage>
+#include <QObject>
+#include <QPoint>
+#include <QSize>
+#include <QTimer>
+
+#include <memory>
+
+#include "animationdecoder.h"
+#include "framestore.h"
+#include "jitterhistogram.h"
+#include "memorybudget.h"
+
+// 动画壁纸播放：第一轮播放时在工作线程中把每帧解码并缩放到屏幕尺寸，只保存变化区域；之后的循环只拷贝变化区域，不再解码
+// 估算帧缓存超出可用内存时改为按源分辨率压缩存储，显示时再展开并缩放变化区域；展开比解码还慢或仍超出预算时改由解码线程循环解码，界面线程按显示时刻从帧队列取出变化区域拷贝
+// 每帧按单调的播放时钟上的绝对时刻调度，不随定时器误差累积；界面线程落后时跳过中间帧，只显示最新到时的一帧
+class AnimationPlayer : public QObject, public MemoryConsumer
+{
+    Q_OBJECT
+
+public:
+    struct Statistics
+    {
+        int framesDecoded;                      // 解码的帧数，帧缓存完整后不再增加
+        int framesPresented;
+        int framesLate;                         // 晚于显示时刻才取到的帧
+        int queueDepth;                         // 帧队列中已解码待显示的帧数
+        int queueCapacity;
+        qint64 storeBytes;
+        bool stored;                            // 是否从帧缓存播放
+        int compressedFrames;                   // 帧缓存中压缩存储的帧数
+        double expandMs;                        // 压缩帧平均展开耗时
+        int framesSkipped;                      // 落后时直接拷贝而不单独显示的帧
+    };
+
+    explicit AnimationPlayer(QObject *parent = nullptr);
+    ~AnimationPlayer();
+
+    bool start(const QString &path, const QSize &size, qreal devicePixelRatio = 1.0);
+    void stop();
+
+    void setPaused(bool paused);
+    bool isPaused() const;
+    bool isRunning() const;
+
+    Statistics statistics() const;
+    const JitterHistogram &jitter() const;
+
+    QString memoryName() const override;
+    qint64 memoryUsage() const override;
+    int memoryPriority() const override;
+    qint64 releaseMemory(qint64 bytes) override;
+
+signals:
+    void patchReady(const QImage &patch, const QPoint &position);       // 屏幕尺寸的变化区域
+    void failed();                                                      // 文件损坏或格式不支持，一帧也没有解码出来
+
+private slots:
+    void onTick();
+    void onFrameQueued();
+
+private:
+    void decodeAll(const QString &path, const QSize &size, qreal devicePixelRatio, qint64 allowance,
+                   int generation, std::shared_ptr<QAtomicInt> cancel);
+    void onDeltaDecoded(int generation, const FrameStore::Delta &delta);
+    void onDecodeFinished(int generation, const FrameStore::Delta &loop);
+    void onPackingTooSlow(int generation);
+    void onDecodeFailed(int generation);
+    void present(const FrameStore::Delta &delta);
+    void fallBackToQueue();
+    static bool pack(FrameStore::Delta *delta, const QImage &previous, const QImage &current,
+                     const QSize &size, qint64 *expandNs);
+    void cancelDecode();
+    bool nextDue(qint64 *due) const;
+    void advance(qint64 due);
+    void waitForFrame();
+    void scheduleNext();
+    void scheduleAt(qint64 due);
+    qint64 position() const;
+
+private:
+    QString m_path;
+    QSize m_size;
+    qreal m_devicePixelRatio = 1.0;
+
+    FrameStore m_store;
+    int m_index = -1;                           // 当前显示的帧
+    bool m_waiting = false;                     // 下一帧尚未解码完成
+    bool m_streaming = false;                   // 从帧队列播放
+
+    AnimationDecoder *m_pDecoder = new AnimationDecoder(4, this);
+    QElapsedTimer m_clock;                      // 播放时钟，暂停时停止计时
+    qint64 m_clockOffset = 0;                   // 以下时刻均为播放时钟上的微秒数
+    qint64 m_due = 0;                           // 当前帧的计划显示时刻
+    qint64 m_queueBase = 0;                     // 帧队列时间戳的零点
+    JitterHistogram m_jitter;
+
+    QFuture<void> m_decode;
+    std::shared_ptr<QAtomicInt> m_cancel;
+    int m_generation = 0;                       // 作废已排队的解码结果
+
+    QTimer m_timer;
+    bool m_paused = false;
+    bool m_running = false;
+
+    QImage m_canvas;                            // 压缩帧展开后的源分辨率画面
+    QImage m_scratch;                           // 压缩帧缩放后的变化区域
+    qint64 m_expandNs = 0;
+    int m_expanded = 0;
+
+    Statistics m_statistics = { 0, 0, 0, 0, 0, 0, true, 0, 0.0, 0 };
+};
+
+#endif // ANIMATIONPLAYER_H
@@ -0,0 +1,143 @@
+#include "animationsource.h"
+
+#include <QImageReader>
+
+#include "apngsource.h"
+
+namespace
+{
+const int MinDelay     = 10;
+const int ClampedDelay = 100;
+
+// GIF 与动态 WebP 由 Qt 的图片插件解码，读出的每帧已经合成为整幅画面
+class ReaderSource : public AnimationSource
+{
+public:
+    explicit ReaderSource(const char *format) : m_format(format)
+    { }
+
+    bool open(const QString &path) override
+    {
+        m_path = path;
+        m_pReader.reset(new QImageReader(path, m_format));
+
+        return m_pReader->canRead();
+    }
+
+    QImage read() override
+    {
+        return m_pReader ? m_pReader->read() : QImage();
+    }
+
+    int nextDelay() const override
+    {
+        return m_pReader ? m_pReader->nextImageDelay() : 0;
+    }
+
+    QSize size() const override
+    {
+        return m_pReader ? m_pReader->size() : QSize();
+    }
+
+    int frameCount() const override
+    {
+        return m_pReader ? m_pReader->imageCount() : -1;
+    }
+
+    bool skip(int count) override
+    {
+        if (m_pReader && count > 0 && m_pReader->jumpToImage(count))
+            return true;
+
+        return AnimationSource::skip(count);
+    }
+
+private:
+    QByteArray m_format;
+    std::unique_ptr<QImageReader> m_pReader;
+};
+
+AnimationSource *createGif()
+{
+    return new ReaderSource("gif");
+}
+
+AnimationSource *createWebp()
+{
+    return new ReaderSource("webp");
+}
+
+AnimationSource *createApng()
+{
+    return new ApngSource();
+}
+
+AnimationSource::Factory *factories()
+{
+    // 内置格式，其余格式在启动时通过 registerSource 加入
+    static AnimationSource::Factory table[MediaRegistry::FormatCount] = { };
+    static bool initialized = [](){
+        table[MediaRegistry::GifFormat]          = createGif;
+        table[MediaRegistry::AnimatedWebpFormat] = createWebp;
+        table[MediaRegistry::ApngFormat]         = createApng;
+        return true;
+    }();
+    Q_UNUSED(initialized)
+
+    return table;
+}
+}
+
+AnimationSource::~AnimationSource()
+{
+}
+
+bool AnimationSource::rewind()
+{
+    return open(m_path);
+}
+
+bool AnimationSource::skip(int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (read().isNull())
+            return false;
+    }
+
+    return true;
+}
+
+QString AnimationSource::path() const
+{
+    return m_path;
+}
+
+int AnimationSource::clampDelay(int delay)
+{
+    return delay <= MinDelay ? ClampedDelay : delay;
+}
+
+void AnimationSource::registerSource(MediaRegistry::Format format, Factory factory)
+{
+    if (format > MediaRegistry::UnknownFormat && format < MediaRegistry::FormatCount)
+        factories()[format] = factory;
+}
+
+bool AnimationSource::supports(MediaRegistry::Format format)
+{
+    return format > MediaRegistry::UnknownFormat && format < MediaRegistry::FormatCount && factories()[format] != nullptr;
+}
+
+std::unique_ptr<AnimationSource> AnimationSource::create(const QString &path)
+{
+    const MediaRegistry::Format format = MediaRegistry::sniff(path);
+    if (!supports(format))
+        return nullptr;
+
+    std::unique_ptr<AnimationSource> source(factories()[format]());
+    if (!source->open(path))
+        return nullptr;
+
+    return source;
+}
@@ -0,0 +1,42 @@
+#ifndef ANIMATIONSOURCE_H
+#define ANIMATIONSOURCE_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+#include <memory>
+
+#include "mediaregistry.h"
+
+// 动画容器解码接口：逐帧输出合成后的整幅画面，帧缓存与帧队列不关心具体格式
+// 各格式的实现按 MediaRegistry::Format 注册，在工作线程中创建和使用
+class AnimationSource
+{
+public:
+    typedef AnimationSource *(*Factory)();
+
+    virtual ~AnimationSource();
+
+    virtual bool open(const QString &path) = 0;
+    virtual QImage read() = 0;                  // 下一帧的整幅画面，读完或出错时为空
+    virtual int nextDelay() const = 0;          // 刚读出的帧的显示时长，毫秒
+    virtual QSize size() const = 0;
+    virtual int frameCount() const = 0;         // 未知时为 -1
+    virtual bool rewind();
+    virtual bool skip(int count);
+
+    QString path() const;
+
+    // 与浏览器相同：10 毫秒及以下的帧间隔按 100 毫秒播放
+    static int clampDelay(int delay);
+
+    static void registerSource(MediaRegistry::Format format, Factory factory);
+    static bool supports(MediaRegistry::Format format);
+    static std::unique_ptr<AnimationSource> create(const QString &path);
+
+protected:
+    QString m_path;
+};
+
+#endif // ANIMATIONSOURCE_H
@@ -0,0 +1,251 @@
+#include "apngsource.h"
+
+#include <QFile>
+#include <QPainter>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace
+{
+const char PngSignature[] = "\x89PNG\r\n\x1A\n";
+const int MaxDimension = 16384;
+
+quint32 crc32(const char *type, const QByteArray &data)
+{
+    static quint32 table[256];
+    static bool initialized = [](){
+        for (quint32 n = 0; n < 256; ++n)
+        {
+            quint32 c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return true;
+    }();
+    Q_UNUSED(initialized)
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (int i = 0; i < 4; ++i)
+        crc = table[(crc ^ quint8(type[i])) & 0xFF] ^ (crc >> 8);
+    for (int i = 0; i < data.size(); ++i)
+        crc = table[(crc ^ quint8(data.at(i))) & 0xFF] ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void appendChunk(QByteArray &png, const char *type, const QByteArray &data)
+{
+    uchar word[4];
+
+    qToBigEndian(quint32(data.size()), word);
+    png.append(reinterpret_cast<const char *>(word), 4);
+    png.append(type, 4);
+    png.append(data);
+    qToBigEndian(crc32(type, data), word);
+    png.append(reinterpret_cast<const char *>(word), 4);
+}
+
+quint32 readUInt32(const char *data)
+{
+    return qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(data));
+}
+
+quint16 readUInt16(const char *data)
+{
+    return qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(data));
+}
+}
+
+bool ApngSource::open(const QString &path)
+{
+    m_path = path;
+    m_frames.clear();
+    m_header.clear();
+    m_shared.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || !parse(file.readAll()))
+        return false;
+
+    return rewind();
+}
+
+QImage ApngSource::read()
+{
+    if (m_index + 1 >= m_frames.size())
+        return QImage();
+
+    disposePrevious();
+
+    const Frame &frame = m_frames.at(++m_index);
+    QImage image = decodeFrame(frame);
+    if (image.isNull())
+    {
+        m_index = m_frames.size();
+        return QImage();
+    }
+
+    // 处置方式为恢复的帧先保存将被覆盖的区域，第一帧按清除处理
+    if (frame.dispose == DisposePrevious && m_index > 0)
+        m_saved = m_canvas.copy(frame.rect);
+
+    QPainter painter(&m_canvas);
+    painter.setCompositionMode(frame.blend == BlendOver ? QPainter::CompositionMode_SourceOver
+                                                        : QPainter::CompositionMode_Source);
+    painter.drawImage(frame.rect.topLeft(), image);
+    painter.end();
+
+    return m_canvas;
+}
+
+int ApngSource::nextDelay() const
+{
+    return m_index >= 0 && m_index < m_frames.size() ? m_frames.at(m_index).delay : 0;
+}
+
+QSize ApngSource::size() const
+{
+    return m_size;
+}
+
+int ApngSource::frameCount() const
+{
+    return m_frames.size();
+}
+
+bool ApngSource::rewind()
+{
+    if (m_frames.isEmpty())
+        return false;
+
+    m_canvas = QImage(m_size, QImage::Format_ARGB32_Premultiplied);
+    m_canvas.fill(Qt::transparent);
+    m_saved = QImage();
+    m_index = -1;
+
+    return true;
+}
+
+bool ApngSource::parse(const QByteArray &file)
+{
+    if (file.size() < 8 || memcmp(file.constData(), PngSignature, 8) != 0)
+        return false;
+
+    Frame *current = nullptr;
+    bool seenData = false;                      // 已出现 IDAT，此后的辅助块不再属于共用部分
+
+    for (int offset = 8; offset + 12 <= file.size(); )
+    {
+        const quint32 length = readUInt32(file.constData() + offset);
+        if (length > quint32(file.size() - offset - 12))
+            return false;
+
+        const char *type = file.constData() + offset + 4;
+        const char *data = file.constData() + offset + 8;
+
+        if (memcmp(type, "IHDR", 4) == 0 && length == 13)
+        {
+            m_header = QByteArray(data, 13);
+            m_size = QSize(int(readUInt32(data)), int(readUInt32(data + 4)));
+        }
+        else if (memcmp(type, "fcTL", 4) == 0 && length >= 26)
+        {
+            const int width  = int(readUInt32(data + 4));
+            const int height = int(readUInt32(data + 8));
+            const int x      = int(readUInt32(data + 12));
+            const int y      = int(readUInt32(data + 16));
+            const int num    = readUInt16(data + 20);
+            const int den    = readUInt16(data + 22);
+
+            // 分母为 0 时按百分之一秒计
+            Frame frame = { QRect(x, y, width, height), num * 1000 / (den != 0 ? den : 100),
+                            quint8(data[24]), quint8(data[25]), QVector<QByteArray>() };
+            m_frames.append(frame);
+            current = &m_frames.last();
+        }
+        else if (memcmp(type, "IDAT", 4) == 0)
+        {
+            // 没有 fcTL 在前的默认图片不属于动画
+            seenData = true;
+            if (current != nullptr)
+                current->data.append(QByteArray(data, int(length)));
+        }
+        else if (memcmp(type, "fdAT", 4) == 0 && length > 4)
+        {
+            if (current != nullptr)
+                current->data.append(QByteArray(data + 4, int(length) - 4));
+        }
+        else if (memcmp(type, "IEND", 4) == 0)
+        {
+            break;
+        }
+        else if (!seenData && memcmp(type, "acTL", 4) != 0)
+        {
+            m_shared.append(file.mid(offset, int(length) + 12));
+        }
+
+        offset += int(length) + 12;
+    }
+
+    if (m_header.isEmpty() || m_size.isEmpty() || m_size.width() > MaxDimension || m_size.height() > MaxDimension)
+        return false;
+
+    // 超出画布或没有数据的帧视为文件损坏
+    const QRect canvas(QPoint(0, 0), m_size);
+    for (const Frame &frame : m_frames)
+    {
+        if (frame.rect.isEmpty() || !canvas.contains(frame.rect) || frame.data.isEmpty())
+            return false;
+    }
+
+    return !m_frames.isEmpty();
+}
+
+QImage ApngSource::decodeFrame(const Frame &frame) const
+{
+    QByteArray header = m_header;
+    uchar word[4];
+
+    qToBigEndian(quint32(frame.rect.width()), word);
+    header.replace(0, 4, reinterpret_cast<const char *>(word), 4);
+    qToBigEndian(quint32(frame.rect.height()), word);
+    header.replace(4, 4, reinterpret_cast<const char *>(word), 4);
+
+    QByteArray png(PngSignature, 8);
+    appendChunk(png, "IHDR", header);
+    png.append(m_shared);
+    for (const QByteArray &data : frame.data)
+        appendChunk(png, "IDAT", data);
+    appendChunk(png, "IEND", QByteArray());
+
+    QImage image = QImage::fromData(png, "png");
+    if (image.isNull() || image.size() != frame.rect.size())
+        return QImage();
+
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+void ApngSource::disposePrevious()
+{
+    if (m_index < 0)
+        return;
+
+    const Frame &previous = m_frames.at(m_index);
+
+    if (previous.dispose == DisposeBackground || (previous.dispose == DisposePrevious && m_saved.isNull()))
+    {
+        QPainter painter(&m_canvas);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(previous.rect, Qt::transparent);
+    }
+    else if (previous.dispose == DisposePrevious)
+    {
+        QPainter painter(&m_canvas);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(previous.rect.topLeft(), m_saved);
+    }
+
+    m_saved = QImage();
+}
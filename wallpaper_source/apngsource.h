@@ -0,0 +1,60 @@
+#ifndef APNGSOURCE_H
+#define APNGSOURCE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+#include "animationsource.h"
+
+// APNG 解码：按 fcTL/fdAT 拆出每帧的压缩数据，拼成独立的 PNG 交给 Qt 解码，再按处置与混合方式合成到画布
+class ApngSource : public AnimationSource
+{
+public:
+    bool open(const QString &path) override;
+    QImage read() override;
+    int nextDelay() const override;
+    QSize size() const override;
+    int frameCount() const override;
+    bool rewind() override;
+
+private:
+    enum DisposeOp
+    {
+        DisposeNone = 0,
+        DisposeBackground,
+        DisposePrevious
+    };
+
+    enum BlendOp
+    {
+        BlendSource = 0,
+        BlendOver
+    };
+
+    struct Frame
+    {
+        QRect rect;
+        int delay;
+        quint8 dispose;
+        quint8 blend;
+        QVector<QByteArray> data;               // 去掉序号后的 zlib 数据，按顺序拼接
+    };
+
+    bool parse(const QByteArray &file);
+    QImage decodeFrame(const Frame &frame) const;
+    void disposePrevious();
+
+private:
+    QByteArray m_header;                        // IHDR 数据，解码单帧时替换宽高
+    QByteArray m_shared;                        // PLTE、tRNS 等各帧共用的完整块
+    QSize m_size;
+    QVector<Frame> m_frames;
+
+    QImage m_canvas;
+    QImage m_saved;                             // DisposePrevious 帧绘制前的画布区域
+    int m_index = -1;                           // 最近读出的帧
+};
+
+#endif // APNGSOURCE_H
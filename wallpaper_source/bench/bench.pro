@@ -0,0 +1,54 @@
+QT       += core gui concurrent
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = wallpaper_bench
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD/..
+
+SOURCES += \
+    main.cpp \
+    ../animationdecoder.cpp \
+    ../animationplayer.cpp \
+    ../animationsource.cpp \
+    ../apngsource.cpp \
+    ../contenthash.cpp \
+    ../framequeue.cpp \
+    ../framestore.cpp \
+    ../imagedecoder.cpp \
+    ../imageresampler.cpp \
+    ../imageslideshow.cpp \
+    ../jitterhistogram.cpp \
+    ../mediaregistry.cpp \
+    ../memorybudget.cpp \
+    ../palettecodec.cpp \
+    ../pixelkernels.cpp \
+    ../playlist.cpp \
+    ../resolutionvariants.cpp \
+    ../wallpapercache.cpp
+
+HEADERS += \
+    ../animationdecoder.h \
+    ../animationplayer.h \
+    ../animationsource.h \
+    ../apngsource.h \
+    ../contenthash.h \
+    ../framequeue.h \
+    ../framestore.h \
+    ../imagedecoder.h \
+    ../imageresampler.h \
+    ../imageslideshow.h \
+    ../jitterhistogram.h \
+    ../mediaregistry.h \
+    ../memorybudget.h \
+    ../palettecodec.h \
+    ../pixelkernels.h \
+    ../playlist.h \
+    ../resolutionvariants.h \
+    ../wallpapercache.h
+
+win32: LIBS += -lpsapi
@@ -0,0 +1,757 @@
+#include <QCommandLineParser>
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QImageReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QPainter>
+#include <QPixmap>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#  include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#  include <sys/resource.h>
+#endif
+
+#include "animationplayer.h"
+#include "animationsource.h"
+#include "framestore.h"
+#include "imagedecoder.h"
+#include "imageresampler.h"
+#include "imageslideshow.h"
+#include "mediaregistry.h"
+#include "pixelkernels.h"
+#include "playlist.h"
+#include "wallpapercache.h"
+
+// 基于 image/ 样例壁纸的性能测试：解码、缩放、首帧显示耗时、GIF 帧吞吐与峰值内存，结果输出为 JSON
+namespace
+{
+struct Options
+{
+    QSize target;
+    int repeat;
+    int playSeconds;                            // 动画实际播放的时长，为 0 时不播放
+};
+
+// 多次运行取最快一次，单位毫秒
+template<typename Func>
+double measure(int repeat, Func func)
+{
+    QElapsedTimer timer;
+    qint64 best = std::numeric_limits<qint64>::max();
+
+    for (int i = 0; i < repeat; ++i)
+    {
+        timer.start();
+        func();
+        best = qMin(best, timer.nsecsElapsed());
+    }
+
+    return best / 1e6;
+}
+
+void resetPeakRss()
+{
+#if defined(Q_OS_LINUX)
+    // 写入 5 可重置 VmHWM，旧内核不支持时峰值保持单调递增
+    QFile file(QStringLiteral("/proc/self/clear_refs"));
+    if (file.open(QIODevice::WriteOnly))
+        file.write("5");
+#endif
+}
+
+qint64 peakRssKb()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize / 1024);
+#elif defined(Q_OS_LINUX)
+    QFile file(QStringLiteral("/proc/self/status"));
+    if (file.open(QIODevice::ReadOnly))
+    {
+        for (auto line : file.readAll().split('\n'))
+            if (line.startsWith("VmHWM:"))
+                return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+    }
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return qint64(usage.ru_maxrss / 1024);
+#endif
+    return -1;
+}
+
+double processCpuMs()
+{
+#if defined(Q_OS_WIN)
+    FILETIME creation, exit, kernel, user;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+    {
+        const quint64 total = (quint64(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime)
+                            + (quint64(user.dwHighDateTime) << 32 | user.dwLowDateTime);
+        return total / 1e4;
+    }
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+#endif
+    return -1;
+}
+
+void appendChunk(QByteArray &png, const char *type, const QByteArray &data)
+{
+    static quint32 table[256];
+    static bool initialized = [](){
+        for (quint32 n = 0; n < 256; ++n)
+        {
+            quint32 c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return true;
+    }();
+    Q_UNUSED(initialized)
+
+    const QByteArray body = QByteArray(type, 4) + data;
+    quint32 crc = 0xFFFFFFFFu;
+    for (char byte : body)
+        crc = table[(crc ^ quint8(byte)) & 0xFF] ^ (crc >> 8);
+
+    uchar word[4];
+    qToBigEndian(quint32(data.size()), word);
+    png.append(reinterpret_cast<const char *>(word), 4);
+    png.append(body);
+    qToBigEndian(crc ^ 0xFFFFFFFFu, word);
+    png.append(reinterpret_cast<const char *>(word), 4);
+}
+
+QByteArray bigEndian32(quint32 value)
+{
+    uchar word[4];
+    qToBigEndian(value, word);
+    return QByteArray(reinterpret_cast<const char *>(word), 4);
+}
+
+QByteArray bigEndian16(quint16 value)
+{
+    uchar word[2];
+    qToBigEndian(value, word);
+    return QByteArray(reinterpret_cast<const char *>(word), 2);
+}
+
+// 把动画逐帧转存为 APNG，每帧只编码相对上一帧变化的区域，用于同一动画不同格式的对比
+bool writeApng(const QString &source, const QString &target)
+{
+    std::unique_ptr<AnimationSource> animation = AnimationSource::create(source);
+    if (!animation)
+        return false;
+
+    QByteArray header;
+    QByteArray body;
+    QImage previous;
+    quint32 frames = 0;
+    quint32 sequence = 0;
+
+    for (QImage frame = animation->read(); !frame.isNull(); frame = animation->read())
+    {
+        frame = frame.convertToFormat(QImage::Format_ARGB32);
+
+        QRect rect = FrameStore::diff(previous, frame, 0).rect;
+        if (rect.isEmpty())
+            rect = QRect(0, 0, 1, 1);
+        previous = frame;
+
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        if (!frame.copy(rect).save(&buffer, "png"))
+            return false;
+
+        // 帧控制块：序号、区域、显示时长（毫秒）、不处置、直接覆盖
+        const quint16 delay = quint16(qBound(0, animation->nextDelay(), 65535));
+        QByteArray control = bigEndian32(sequence++)
+                           + bigEndian32(quint32(rect.width())) + bigEndian32(quint32(rect.height()))
+                           + bigEndian32(quint32(rect.x())) + bigEndian32(quint32(rect.y()))
+                           + bigEndian16(delay) + bigEndian16(1000);
+        control.append(char(0)).append(char(0));
+        appendChunk(body, "fcTL", control);
+
+        for (int offset = 8; offset + 12 <= png.size(); )
+        {
+            const int length = int(qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(png.constData() + offset)));
+            const QByteArray type = png.mid(offset + 4, 4);
+            const QByteArray data = png.mid(offset + 8, length);
+
+            if (type == "IHDR" && frames == 0)
+                header = data;
+            else if (type == "IDAT" && frames == 0)
+                appendChunk(body, "IDAT", data);
+            else if (type == "IDAT")
+                appendChunk(body, "fdAT", bigEndian32(sequence++) + data);
+
+            offset += length + 12;
+        }
+
+        ++frames;
+    }
+
+    if (frames == 0 || header.isEmpty())
+        return false;
+
+    QByteArray apng("\x89PNG\r\n\x1A\n", 8);
+    appendChunk(apng, "IHDR", header);
+    appendChunk(apng, "acTL", bigEndian32(frames) + bigEndian32(0));
+    apng.append(body);
+    appendChunk(apng, "IEND", QByteArray());
+
+    QFile file(target);
+    return file.open(QIODevice::WriteOnly) && file.write(apng) == apng.size();
+}
+
+QString containerName(MediaRegistry::Format format)
+{
+    switch (format)
+    {
+    case MediaRegistry::GifFormat:
+        return QStringLiteral("gif");
+    case MediaRegistry::AnimatedWebpFormat:
+        return QStringLiteral("webp");
+    case MediaRegistry::ApngFormat:
+        return QStringLiteral("apng");
+    default:
+        return QString();
+    }
+}
+
+QString resolutionClass(const QString &path, const QSize &size)
+{
+    // 样例目录按分辨率命名，例如 image/1920x1080
+    QString dir = QFileInfo(path).dir().dirName();
+    if (QRegularExpression(QStringLiteral("^\\d+x\\d+$")).match(dir).hasMatch())
+        return dir;
+
+    return QStringLiteral("%1x%2").arg(size.width()).arg(size.height());
+}
+
+QJsonObject benchStill(const QString &path, const Options &options)
+{
+    QJsonObject result;
+    QImage full;
+
+    const double decode = measure(options.repeat, [&](){ full = QImageReader(path).read(); });
+    if (full.isNull())
+        return result;
+
+    full = full.convertToFormat(full.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    const double mp = full.width() * full.height() / 1e6;
+
+    QJsonObject scale;
+    scale.insert("qtSmoothMs", measure(options.repeat, [&](){ full.scaled(options.target, Qt::IgnoreAspectRatio, Qt::SmoothTransformation); }));
+
+    auto resample = [&](const char *name, int mask, int threads){
+        PixelKernels::setFeatureMask(mask);
+        scale.insert(name, measure(options.repeat, [&](){ ImageResampler::scaled(full, options.target, ImageResampler::LanczosFilter, threads); }));
+    };
+    resample("lanczosScalarMs", 0, 1);
+    resample("lanczosSse41Ms", PixelKernels::SSE41, 1);
+    resample("lanczosAvx2Ms", PixelKernels::SSE41 | PixelKernels::AVX2, 1);
+    resample("lanczosMs", -1, 0);
+    PixelKernels::setFeatureMask(-1);
+
+    const double lanczos = scale.value("lanczosMs").toDouble();
+    scale.insert("lanczosMpPerSec", lanczos > 0 ? mp / (lanczos / 1e3) : 0.0);
+
+    // 首帧显示：格式识别 + 缩放解码 + 转为 QPixmap，分别测量磁盘缓存未命中与命中
+    auto firstPixel = [&](){
+        QPixmap pixmap = QPixmap::fromImage(ImageDecoder::decodeFile(path, options.target, 1.0), Qt::NoFormatConversion);
+        Q_UNUSED(pixmap)
+    };
+
+    WallpaperCache::instance()->clear();
+    QElapsedTimer timer;
+    timer.start();
+    firstPixel();
+    const double cold = timer.nsecsElapsed() / 1e6;
+    const double warm = measure(options.repeat, firstPixel);
+
+    result.insert("width", full.width());
+    result.insert("height", full.height());
+    result.insert("decodeMs", decode);
+    result.insert("scale", scale);
+    result.insert("firstPixelColdMs", cold);
+    result.insert("firstPixelWarmMs", warm);
+
+    return result;
+}
+
+// 压缩帧缓存：与动画壁纸相同，每帧的源分辨率变化区域按调色板下标加游程编码保存，每轮展开、缩放后再拷贝
+QJsonObject benchPacked(const QString &path, const QSize &target, int repeat)
+{
+    QJsonObject result;
+    std::unique_ptr<AnimationSource> source = AnimationSource::create(path);
+    if (!source)
+        return result;
+
+    FrameStore packed;
+    int packedFrames = 0;
+    QImage previous;
+    QImage first;
+    QImage base;
+    QImage firstSource;
+    bool firstPacked = false;
+
+    for (QImage frame = source->read(); !frame.isNull(); frame = source->read())
+    {
+        frame = frame.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        const QImage scaled = ImageResampler::scaled(frame, target);
+
+        FrameStore::Delta delta = FrameStore::diff(previous, scaled, source->nextDelay());
+        if (FrameStore::pack(&delta, base, frame, target))
+        {
+            base = frame;
+            firstPacked = firstPacked || first.isNull();
+            if (!delta.packed.isEmpty())
+                ++packedFrames;
+        }
+        else
+        {
+            base = QImage();
+        }
+
+        packed.append(delta);
+        if (first.isNull())
+        {
+            first = scaled;
+            firstSource = frame;
+        }
+        previous = scaled;
+    }
+
+    if (first.isNull())
+        return result;
+
+    FrameStore::Delta loop = FrameStore::diff(previous, first, 0);
+    if (!FrameStore::pack(&loop, base, firstSource, target) && firstPacked)
+        FrameStore::pack(&loop, QImage(), firstSource, target);
+    packed.setLoopDelta(loop);
+
+    QImage screen(target, QImage::Format_ARGB32_Premultiplied);
+    QImage canvas;
+    QImage scratch;
+    auto blit = [&](const FrameStore::Delta &delta){
+        const QImage *patch = &delta.patch;
+        if (!delta.packed.isEmpty() && FrameStore::expand(delta, target, &canvas, &scratch))
+            patch = &scratch;
+
+        for (int y = 0; y < delta.rect.height() && y < patch->height(); ++y)
+            memcpy(screen.scanLine(delta.rect.top() + y) + delta.rect.left() * 4,
+                   patch->constScanLine(y), size_t(delta.rect.width()) * 4);
+    };
+
+    // 第一帧整帧展开一次建立画布，之后按循环顺序回放
+    blit(packed.at(0));
+    const double loopMs = measure(repeat, [&](){
+        blit(packed.loopDelta());
+        for (int i = 1; i < packed.count(); ++i)
+            blit(packed.at(i));
+    });
+
+    result.insert("target", QStringLiteral("%1x%2").arg(target.width()).arg(target.height()));
+    result.insert("packedLoopMs", loopMs);
+    result.insert("packedBytes", double(packed.sizeInBytes()));
+    result.insert("packedFrames", packedFrames);
+
+    return result;
+}
+
+QJsonObject benchAnimation(const QString &path, const Options &options)
+{
+    QJsonObject result;
+    int frames = 0;
+
+    // 解码整个动画的耗时与处理器时间，处理器时间按全部运行次数平均到每帧
+    const double cpuStart = processCpuMs();
+    const double total = measure(options.repeat, [&](){
+        std::unique_ptr<AnimationSource> source = AnimationSource::create(path);
+        frames = 0;
+        while (source && !source->read().isNull())
+            ++frames;
+    });
+    const double cpu = processCpuMs() - cpuStart;
+
+    if (frames == 0)
+        return result;
+
+    // 帧缓存：第一轮解码、缩放到屏幕尺寸并求差异；之后每轮只把变化区域拷贝到屏幕缓冲
+    FrameStore store;
+    const double firstLoop = measure(options.repeat, [&](){
+        std::unique_ptr<AnimationSource> source = AnimationSource::create(path);
+        QImage first;
+        QImage previous;
+
+        store.clear();
+        for (QImage frame = source->read(); !frame.isNull(); frame = source->read())
+        {
+            frame = ImageResampler::scaled(frame.convertToFormat(QImage::Format_ARGB32_Premultiplied), options.target);
+            store.append(FrameStore::diff(previous, frame, source->nextDelay()));
+            if (first.isNull())
+                first = frame;
+            previous = frame;
+        }
+        store.setLoopDelta(FrameStore::diff(previous, first, 0));
+    });
+
+    QImage screen(options.target, QImage::Format_ARGB32_Premultiplied);
+    auto blit = [&](const FrameStore::Delta &delta){
+        for (int y = 0; y < delta.rect.height(); ++y)
+            memcpy(screen.scanLine(delta.rect.top() + y) + delta.rect.left() * 4,
+                   delta.patch.constScanLine(y), size_t(delta.rect.width()) * 4);
+    };
+    const double loop = measure(options.repeat, [&](){
+        blit(store.loopDelta());
+        for (int i = 1; i < store.count(); ++i)
+            blit(store.at(i));
+    });
+
+    // 压缩帧缓存在目标尺寸与源尺寸相同时只是拷贝，另取一个与源尺寸不同的尺寸测量展开时的缩放
+    const QSize size = AnimationSource::create(path)->size();
+    const QJsonObject packed = benchPacked(path, options.target, options.repeat);
+    const QSize scaledTarget = options.target != size ? options.target : options.target * 3 / 2;
+
+    result.insert("width", size.width());
+    result.insert("height", size.height());
+    result.insert("frames", frames);
+    result.insert("fileBytes", double(QFileInfo(path).size()));
+    result.insert("decodeAllMs", total);
+    result.insert("framesPerSec", total > 0 ? frames / (total / 1e3) : 0.0);
+    result.insert("cpuPerFrameMs", cpu >= 0 ? cpu / (frames * options.repeat) : -1.0);
+    result.insert("storeFirstLoopMs", firstLoop);
+    result.insert("storeLoopMs", loop);
+    result.insert("storeBytes", double(store.sizeInBytes()));
+    result.insert("packedLoopMs", packed.value("packedLoopMs"));
+    result.insert("packedBytes", packed.value("packedBytes"));
+    result.insert("packedFrames", packed.value("packedFrames"));
+    result.insert("packedScaled", scaledTarget == options.target ? packed : benchPacked(path, scaledTarget, options.repeat));
+
+    // 按动画壁纸的方式实际播放若干秒，记录帧显示抖动，便于对比不同构建的计时精度
+    if (options.playSeconds > 0)
+    {
+        AnimationPlayer player;
+        QObject::connect(&player, &AnimationPlayer::patchReady, [&](const QImage &patch, const QPoint &position){
+            for (int y = 0; y < patch.height(); ++y)
+                memcpy(screen.scanLine(position.y() + y) + position.x() * 4, patch.constScanLine(y), size_t(patch.width()) * 4);
+        });
+
+        QEventLoop loop;
+        QTimer::singleShot(options.playSeconds * 1000, &loop, &QEventLoop::quit);
+        player.start(path, options.target);
+        loop.exec();
+
+        const AnimationPlayer::Statistics statistics = player.statistics();
+        QJsonObject playback = player.jitter().toJson();
+        playback.insert("skipped", statistics.framesSkipped);
+        playback.insert("late", statistics.framesLate);
+        playback.insert("stored", statistics.stored);
+        result.insert("playback", playback);
+    }
+
+    return result;
+}
+
+// 尺寸不是 8 的倍数的 JPEG：DCT 缩放解码的请求尺寸须让 Qt 选中同一分母，否则会多一次内部缩放，与相邻的整除尺寸对比
+QJsonArray benchOddJpeg(const QString &dir, const Options &options)
+{
+    // 目标取屏幕的 1/4，1/8 分母对应的源图仍与 4K 相当，不会占用过多内存
+    QJsonArray result;
+    const QSize target = options.target / 4;
+
+    QImage pattern(8, 8, QImage::Format_RGB32);
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 8; ++x)
+            pattern.setPixel(x, y, qRgb(x * 32, y * 32, (x ^ y) * 32));
+
+    for (int denom : { 2, 4, 8 })
+    {
+        const QSize even = target * denom;
+        const QSize odd  = even + QSize(denom - 1, denom - 1);
+        QJsonObject entry;
+
+        for (const QSize &size : { even, odd })
+        {
+            const QString path = dir + QStringLiteral("/jpeg_%1x%2.jpg").arg(size.width()).arg(size.height());
+            pattern.scaled(size).save(path, "jpg", 90);
+
+            QImage image;
+            const double decode = measure(options.repeat, [&](){ image = ImageDecoder::decodeFile(path, target, 1.0, false); });
+
+            QJsonObject measurement;
+            measurement.insert("source", QStringLiteral("%1x%2").arg(size.width()).arg(size.height()));
+            measurement.insert("decodeMs", decode);
+            measurement.insert("outputMatches", image.size() == target);
+            entry.insert(size == even ? "even" : "odd", measurement);
+            QFile::remove(path);
+        }
+
+        entry.insert("denominator", denom);
+        result.append(entry);
+    }
+
+    return result;
+}
+
+// 轮播切换：按壁纸轮播的方式逐张切换 3840x2160 的样例，统计每次切换在界面线程上的耗时；第一轮解码并写入磁盘缓存，第二轮命中缓存
+QJsonObject benchSlideshow(const QStringList &files, int rounds)
+{
+    QJsonObject result;
+    if (files.isEmpty())
+        return result;
+
+    // 与壁纸窗口一样把新图片整幅拷贝到屏幕缓冲
+    const QSize target(3840, 2160);
+    QImage buffer(target, QImage::Format_ARGB32_Premultiplied);
+    int shown = 0;
+
+    ImageSlideshow slideshow;
+    QObject::connect(&slideshow, &ImageSlideshow::currentChanged, [&](const QImage &image){
+        QPainter painter(&buffer);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(0, 0, image);
+        ++shown;
+    });
+
+    auto wait = [&](int count){
+        QElapsedTimer timer;
+        timer.start();
+        while (shown < count && timer.elapsed() < 30000)
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 50);
+    };
+
+    slideshow.setTargetSize(target);
+    slideshow.setFiles(files);
+    slideshow.start();
+    wait(1);
+
+    for (int i = 1; i < files.count() * rounds && shown == i; ++i)
+    {
+        slideshow.next();
+        wait(i + 1);
+    }
+
+    const ImageSlideshow::Statistics statistics = slideshow.statistics();
+    result.insert("files", files.count());
+    result.insert("switches", statistics.switches);
+    result.insert("guiAverageMs", statistics.averageMs);
+    result.insert("guiMaxMs", statistics.maxMs);
+
+    return result;
+}
+
+// 播放列表：写入、重建索引后打开、映射已有索引打开、开始轮播的启动耗时与之后的分批分组、随机访问与追加
+QJsonObject benchPlaylist(const QString &dir, int entries, const Options &options)
+{
+    QJsonObject result;
+    QStringList paths;
+    const QString path = dir + QStringLiteral("/playlist.m3u");
+
+    for (int i = 0; i < entries; ++i)
+        paths.append(QStringLiteral("D:/Pictures/Wallpapers/collection %1/wallpaper_%2.jpg").arg(i / 1000).arg(i));
+
+    Playlist playlist;
+    playlist.open(path);
+
+    result.insert("entries", entries);
+    result.insert("writeMs", measure(options.repeat, [&](){ playlist.setEntries(paths); }));
+    result.insert("openColdMs", measure(options.repeat, [&](){
+        QFile::remove(path + QStringLiteral(".idx"));
+        playlist.open(path);
+    }));
+    result.insert("openWarmMs", measure(options.repeat, [&](){ playlist.open(path); }));
+
+    // 启动：打开播放列表（restoreState）并从第一条开始轮播（loadResourcesFile）在界面线程上的耗时
+    ImageSlideshow slideshow;
+    slideshow.setTargetSize(options.target);
+    result.insert("startupMs", measure(options.repeat, [&](){
+        playlist.open(path);
+        slideshow.setPlaylist(&playlist);
+        slideshow.start();
+    }));
+
+    // 分辨率分组在之后的空闲时间里分批完成，统计总耗时与单批最长耗时
+    slideshow.setPlaylist(&playlist);
+
+    QElapsedTimer group;
+    qint64 slice = 0;
+    group.start();
+    while (!slideshow.isGrouped())
+    {
+        QElapsedTimer timer;
+        timer.start();
+        QCoreApplication::processEvents();
+        slice = qMax(slice, timer.nsecsElapsed());
+    }
+    result.insert("groupMs", group.nsecsElapsed() / 1e6);
+    result.insert("groupSliceMaxMs", slice / 1e6);
+    slideshow.clear();
+
+    QString entry;
+    result.insert("randomAccess1kMs", measure(options.repeat, [&](){
+        for (int i = 0; i < 1000; ++i)
+            entry = playlist.at(int((quint64(i) * 2654435761u) % quint64(entries)));
+    }));
+    result.insert("toStringListMs", measure(options.repeat, [&](){ paths = playlist.toStringList(); }));
+
+    QStringList more;
+    for (int i = 0; i < 1000; ++i)
+        more.append(QStringLiteral("D:/Pictures/New/wallpaper_%1.jpg").arg(i));
+    result.insert("append1kMs", measure(1, [&](){ playlist.append(more); }));
+    result.insert("countAfterAppend", playlist.count());
+
+    return result;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    // 默认无界面运行，便于在构建机上执行
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addPositionalArgument("corpus", "Directory with sample wallpapers (searched recursively).");
+    parser.addOption({ "size", "Target screen size, e.g. 1920x1080.", "size", "1920x1080" });
+    parser.addOption({ "repeat", "Runs per measurement, the fastest one is reported.", "count", "5" });
+    parser.addOption({ "play-seconds", "Seconds each animation is played to record frame timing, 0 to skip.", "seconds", "3" });
+    parser.addOption({ "playlist-entries", "Number of entries in the generated playlist.", "count", "100000" });
+    parser.addOption({ { "o", "output" }, "Write the JSON report to this file instead of stdout.", "file" });
+    parser.process(a);
+
+    const QStringList sizeParts = parser.value("size").split('x');
+    const Options options = { QSize(sizeParts.value(0).toInt(), sizeParts.value(1).toInt()),
+                              qMax(1, parser.value("repeat").toInt()),
+                              qMax(0, parser.value("play-seconds").toInt()) };
+    const QString corpus = parser.positionalArguments().value(0, QStringLiteral("../../image"));
+
+    // 磁盘缓存指向临时目录，不影响本机的壁纸缓存
+    QTemporaryDir cacheDir;
+    WallpaperCache::instance()->setDirectory(cacheDir.path());
+
+    QJsonArray files;
+    QMap<QString, QJsonArray> animations;       // 动画名 -> 各格式的结果
+    QStringList paths;
+
+    QDirIterator it(corpus, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        paths.append(it.next());
+
+    // 样例中的动画另存一份 APNG，与原格式对比；同名的动态 WebP 若在样例中也一并对比
+    QTemporaryDir convertDir;
+    for (const QString &path : QStringList(paths))
+    {
+        const MediaRegistry::Format format = MediaRegistry::sniff(path);
+        if (format == MediaRegistry::GifFormat || format == MediaRegistry::AnimatedWebpFormat)
+        {
+            const QString target = convertDir.filePath(QFileInfo(path).completeBaseName() + QStringLiteral(".png"));
+            if (!QFileInfo::exists(target) && writeApng(path, target))
+                paths.append(target);
+        }
+    }
+
+    QStringList slides;                         // 3840x2160 目录中的静态图片，用于轮播切换测试
+
+    for (const QString &path : paths)
+    {
+        const MediaRegistry::Format format = MediaRegistry::sniff(path);
+        const MediaRegistry::Handler &handler = MediaRegistry::handler(format);
+        if (!(handler.capabilities & MediaRegistry::StillImage))
+            continue;
+
+        if (handler.kind == MediaRegistry::ImageKind && QFileInfo(path).dir().dirName() == QLatin1String("3840x2160"))
+            slides.append(path);
+
+        resetPeakRss();
+
+        const bool animated = handler.capabilities & MediaRegistry::Animation;
+        QJsonObject entry = animated ? benchAnimation(path, options) : benchStill(path, options);
+        if (entry.isEmpty())
+            continue;
+
+        const bool converted = path.startsWith(convertDir.path());
+        entry.insert("file", converted ? QFileInfo(path).fileName() : QDir(corpus).relativeFilePath(path));
+        entry.insert("format", animated ? containerName(format) : QString::fromLatin1(handler.readerFormat));
+        entry.insert("converted", converted);
+        entry.insert("resolutionClass", resolutionClass(path, QSize(entry.value("width").toInt(), entry.value("height").toInt())));
+        entry.insert("peakRssKb", peakRssKb());
+        files.append(entry);
+
+        if (animated)
+        {
+            QJsonObject comparison;
+            for (auto key : { "format", "fileBytes", "cpuPerFrameMs", "decodeAllMs", "storeBytes", "packedBytes", "peakRssKb" })
+                comparison.insert(key, entry.value(key));
+            animations[QFileInfo(path).completeBaseName()].append(comparison);
+        }
+    }
+
+    QJsonObject animationFormats;
+    for (auto group = animations.constBegin(); group != animations.constEnd(); ++group)
+    {
+        if (group.value().size() > 1)
+            animationFormats.insert(group.key(), group.value());
+    }
+
+    QJsonObject report;
+    report.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("qtVersion", QString::fromLatin1(qVersion()));
+    report.insert("target", QStringLiteral("%1x%2").arg(options.target.width()).arg(options.target.height()));
+    report.insert("repeat", options.repeat);
+    report.insert("sse41", bool(PixelKernels::cpuFeatures() & PixelKernels::SSE41));
+    report.insert("avx2", bool(PixelKernels::cpuFeatures() & PixelKernels::AVX2));
+    report.insert("files", files);
+    report.insert("animationFormats", animationFormats);
+    report.insert("oddJpeg", benchOddJpeg(cacheDir.path(), options));
+    report.insert("slideshow", benchSlideshow(slides, 2));
+    report.insert("playlist", benchPlaylist(cacheDir.path(), qMax(1, parser.value("playlist-entries").toInt()), options));
+
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet("output"))
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly))
+            return 1;
+        file.write(json);
+    }
+    else
+    {
+        QTextStream(stdout) << json;
+    }
+
+    return 0;
+}
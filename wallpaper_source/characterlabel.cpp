@@ -1,6 +1,7 @@
 #include "characterlabel.h"
 
 #include <QFontMetrics>
+#include <QPalette>
 #include <QRect>
 
 CharacterLabel::CharacterLabel(QWidget *parent) : QLabel(parent)
@@ -36,6 +37,8 @@ void CharacterLabel::setColor(const QColor &color)
 {
     m_color = color;
 
-    setStyleSheet(QStringLiteral("QLabel {color:rgba(%1, %2, %3, %4);}")
-                                        .arg(color.red()).arg(color.green()).arg(color.blue()).arg(color.alpha()));
+    // 使用调色板而不是样式表，重绘时不经过样式表的解析和匹配
+    QPalette palette = this->palette();
+    palette.setColor(QPalette::WindowText, color);
+    setPalette(palette);
 }
@@ -0,0 +1,184 @@
+#include "contenthash.h"
+
+#include <QFile>
+
+#include <cstring>
+
+namespace
+{
+const quint64 Prime1 = 0x9E3779B185EBCA87ULL;
+const quint64 Prime2 = 0xC2B2AE3D27D4EB4FULL;
+const quint64 Prime3 = 0x165667B19E3779F9ULL;
+const quint64 Prime4 = 0x85EBCA77C2B2AE63ULL;
+const quint64 Prime5 = 0x27D4EB2F165667C5ULL;
+
+// 文件分块读取的大小，边读边算哈希，读完即可直接交给解码器
+const qint64 ChunkSize = 1024 * 1024;
+
+inline quint64 rotl(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline quint64 read64(const char *data)
+{
+    quint64 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline quint32 read32(const char *data)
+{
+    quint32 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline quint64 step(quint64 acc, quint64 input)
+{
+    acc += input * Prime2;
+    acc  = rotl(acc, 31);
+    return acc * Prime1;
+}
+
+inline quint64 mergeStep(quint64 acc, quint64 value)
+{
+    acc ^= step(0, value);
+    return acc * Prime1 + Prime4;
+}
+}
+
+ContentHash::ContentHash(quint64 seed)
+{
+    reset(seed);
+}
+
+void ContentHash::reset(quint64 seed)
+{
+    m_seed     = seed;
+    m_state[0] = seed + Prime1 + Prime2;
+    m_state[1] = seed + Prime2;
+    m_state[2] = seed;
+    m_state[3] = seed - Prime1;
+    m_total    = 0;
+    m_buffered = 0;
+}
+
+void ContentHash::update(const char *data, qint64 size)
+{
+    if (size <= 0)
+        return;
+
+    m_total += quint64(size);
+
+    // 先补齐上次剩下的不完整条带
+    if (m_buffered > 0)
+    {
+        const int fill = int(qMin<qint64>(32 - m_buffered, size));
+        memcpy(m_buffer + m_buffered, data, size_t(fill));
+        m_buffered += fill;
+        data += fill;
+        size -= fill;
+
+        if (m_buffered < 32)
+            return;
+
+        for (int i = 0; i < 4; ++i)
+            m_state[i] = step(m_state[i], read64(m_buffer + i * 8));
+        m_buffered = 0;
+    }
+
+    // 四路独立累加，每次处理 32 字节
+    quint64 v0 = m_state[0], v1 = m_state[1], v2 = m_state[2], v3 = m_state[3];
+
+    for (; size >= 32; data += 32, size -= 32)
+    {
+        v0 = step(v0, read64(data));
+        v1 = step(v1, read64(data + 8));
+        v2 = step(v2, read64(data + 16));
+        v3 = step(v3, read64(data + 24));
+    }
+
+    m_state[0] = v0; m_state[1] = v1; m_state[2] = v2; m_state[3] = v3;
+
+    memcpy(m_buffer, data, size_t(size));
+    m_buffered = int(size);
+}
+
+quint64 ContentHash::digest() const
+{
+    quint64 hash;
+
+    if (m_total >= 32)
+    {
+        hash = rotl(m_state[0], 1) + rotl(m_state[1], 7) + rotl(m_state[2], 12) + rotl(m_state[3], 18);
+        for (int i = 0; i < 4; ++i)
+            hash = mergeStep(hash, m_state[i]);
+    }
+    else
+    {
+        hash = m_seed + Prime5;
+    }
+
+    hash += m_total;
+
+    const char *data = m_buffer;
+    int size = m_buffered;
+
+    for (; size >= 8; data += 8, size -= 8)
+        hash = rotl(hash ^ step(0, read64(data)), 27) * Prime1 + Prime4;
+
+    if (size >= 4)
+    {
+        hash = rotl(hash ^ (quint64(read32(data)) * Prime1), 23) * Prime2 + Prime3;
+        data += 4;
+        size -= 4;
+    }
+
+    for (; size > 0; ++data, --size)
+        hash = rotl(hash ^ (quint64(quint8(*data)) * Prime5), 11) * Prime1;
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+quint64 ContentHash::hash(const QByteArray &data, quint64 seed)
+{
+    ContentHash hasher(seed);
+    hasher.update(data.constData(), data.size());
+    return hasher.digest();
+}
+
+QByteArray ContentHash::readFile(const QString &path, quint64 *hash)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    // 一次分配整个文件的空间，逐块读入并在数据仍在缓存中时计算哈希
+    QByteArray data(int(file.size()), Qt::Uninitialized);
+    ContentHash hasher;
+    qint64 offset = 0;
+
+    while (offset < data.size())
+    {
+        const qint64 read = file.read(data.data() + offset, qMin(ChunkSize, data.size() - offset));
+        if (read <= 0)
+            break;
+
+        hasher.update(data.constData() + offset, read);
+        offset += read;
+    }
+
+    data.truncate(int(offset));
+
+    if (hash != nullptr)
+        *hash = hasher.digest();
+
+    return data;
+}
@@ -0,0 +1,29 @@
+#ifndef CONTENTHASH_H
+#define CONTENTHASH_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// 64 位 xxHash 内容哈希，可分块累加，用于识别内容相同但路径不同的文件
+class ContentHash
+{
+public:
+    explicit ContentHash(quint64 seed = 0);
+
+    void reset(quint64 seed = 0);
+    void update(const char *data, qint64 size);
+    quint64 digest() const;
+
+    static quint64 hash(const QByteArray &data, quint64 seed = 0);
+    static QByteArray readFile(const QString &path, quint64 *hash);
+
+private:
+    quint64 m_state[4];
+    quint64 m_total = 0;
+    char m_buffer[32];                          // 不足一个 32 字节条带的尾部数据
+    int m_buffered = 0;
+    quint64 m_seed = 0;
+};
+
+#endif // CONTENTHASH_H
@@ -0,0 +1,263 @@
+#include "folderindexer.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QtConcurrent>
+
+FolderIndexer::FolderIndexer(QObject *parent) : QObject(parent)
+{
+    // 单线程串行执行扫描与重新列出，保证同一目录的结果按顺序应用
+    m_pool.setMaxThreadCount(1);
+
+    m_relistTimer.setSingleShot(true);
+    m_relistTimer.setInterval(200);
+
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &FolderIndexer::onDirectoryChanged);
+    connect(&m_relistTimer, &QTimer::timeout, this, &FolderIndexer::onRelistTimeout);
+}
+
+FolderIndexer::~FolderIndexer()
+{
+    m_generation.ref();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void FolderIndexer::setDirectory(const QString &dir)
+{
+    clear();
+
+    m_root = QDir(dir).absolutePath();
+    scan(m_root);
+}
+
+QString FolderIndexer::directory() const
+{
+    return m_root;
+}
+
+void FolderIndexer::clear()
+{
+    // 旧的扫描结果带着过期的代数回到界面线程时直接丢弃
+    m_generation.ref();
+    m_pool.clear();
+
+    if (!m_watcher.directories().isEmpty())
+        m_watcher.removePaths(m_watcher.directories());
+
+    m_relistTimer.stop();
+    m_changedDirs.clear();
+    m_index.clear();
+    m_root.clear();
+    m_count = 0;
+    m_runningScans = 0;
+}
+
+int FolderIndexer::count() const
+{
+    return m_count;
+}
+
+bool FolderIndexer::isIndexing() const
+{
+    return m_runningScans > 0;
+}
+
+void FolderIndexer::onDirectoryChanged(const QString &dir)
+{
+    m_changedDirs.insert(dir);
+    m_relistTimer.start();
+}
+
+void FolderIndexer::onRelistTimeout()
+{
+    for (auto dir : m_changedDirs)
+        relist(dir);
+
+    m_changedDirs.clear();
+}
+
+void FolderIndexer::scan(const QString &root)
+{
+    const int generation = m_generation.load();
+    const QStringList filters = nameFilters();
+
+    ++m_runningScans;
+
+    QtConcurrent::run(&m_pool, [=](){
+        // 按目录广度优先扫描，每个目录的结果作为一批送回界面线程
+        QStringList dirs { root };
+
+        for (int i = 0; i < dirs.count() && m_generation.load() == generation; ++i)
+        {
+            const QString dir = dirs.at(i);
+            QDir d(dir);
+            QVector<Entry> entries;
+            QStringList subDirs;
+
+            for (auto info : d.entryInfoList(filters, QDir::Files, QDir::Name))
+                entries.append({ info.fileName(), info.size(), info.lastModified().toMSecsSinceEpoch() });
+
+            for (auto info : d.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+                subDirs.append(info.absoluteFilePath());
+
+            dirs.append(subDirs);
+
+            QMetaObject::invokeMethod(this, [=](){
+                if (generation == m_generation.load())
+                    applyListing(dir, entries, subDirs, false);
+            }, Qt::QueuedConnection);
+        }
+
+        QMetaObject::invokeMethod(this, [=](){
+            if (generation == m_generation.load() && --m_runningScans == 0)
+                emit indexingFinished(m_count);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FolderIndexer::relist(const QString &dir)
+{
+    const int generation = m_generation.load();
+    const QStringList filters = nameFilters();
+
+    QtConcurrent::run(&m_pool, [=](){
+        QDir d(dir);
+        QVector<Entry> entries;
+        QStringList subDirs;
+        bool exists = d.exists();
+
+        if (exists)
+        {
+            for (auto info : d.entryInfoList(filters, QDir::Files, QDir::Name))
+                entries.append({ info.fileName(), info.size(), info.lastModified().toMSecsSinceEpoch() });
+
+            for (auto info : d.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+                subDirs.append(info.absoluteFilePath());
+        }
+
+        QMetaObject::invokeMethod(this, [=](){
+            if (generation != m_generation.load())
+                return;
+
+            if (exists)
+                applyListing(dir, entries, subDirs, true);
+            else
+                removeSubtree(dir);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FolderIndexer::applyListing(const QString &dir, const QVector<Entry> &entries, const QStringList &subDirs, bool recurse)
+{
+    if (!m_index.contains(dir))
+        m_watcher.addPath(dir);
+
+    QHash<QString, Entry> &known = m_index[dir];
+    QHash<QString, Entry> current;
+    current.reserve(entries.count());
+
+    for (auto &entry : entries)
+        current.insert(entry.name, entry);
+
+    QStringList removed;
+    QStringList added;
+
+    for (auto it = known.constBegin(); it != known.constEnd(); ++it)
+        if (!current.contains(it.key()))
+            removed.append(it.key());
+
+    for (auto &entry : entries)
+        if (!known.contains(entry.name))
+            added.append(entry.name);
+
+    // 大小和修改时间完全一致且唯一匹配的一删一增视为改名，轮播中的已解码图片得以保留
+    for (int i = removed.count() - 1; i >= 0; --i)
+    {
+        const Entry &old = known[removed.at(i)];
+        int match = -1;
+
+        for (int j = 0; j < added.count(); ++j)
+        {
+            const Entry &entry = current[added.at(j)];
+            if (entry.size == old.size && entry.modified == old.modified)
+            {
+                match = match == -1 ? j : -2;
+                if (match == -2)
+                    break;
+            }
+        }
+
+        if (match >= 0)
+        {
+            emit fileRenamed(dir + QLatin1Char('/') + removed.at(i), dir + QLatin1Char('/') + added.at(match));
+            removed.removeAt(i);
+            added.removeAt(match);
+        }
+    }
+
+    known = current;
+    m_count += added.count() - removed.count();
+
+    if (!removed.isEmpty())
+    {
+        for (auto &name : removed)
+            name.prepend(dir + QLatin1Char('/'));
+        emit filesRemoved(removed);
+    }
+
+    if (!added.isEmpty())
+    {
+        for (auto &name : added)
+            name.prepend(dir + QLatin1Char('/'));
+        emit filesAdded(added);
+    }
+
+    if (!recurse)
+        return;
+
+    // 新建的子目录单独扫描，消失的子目录连同其下的所有文件一起移除
+    for (auto &subDir : subDirs)
+        if (!m_index.contains(subDir))
+            scan(subDir);
+
+    for (auto &indexed : m_index.keys())
+        if (QFileInfo(indexed).path() == dir && indexed != dir && !subDirs.contains(indexed))
+            removeSubtree(indexed);
+}
+
+void FolderIndexer::removeSubtree(const QString &dir)
+{
+    const QString prefix = dir + QLatin1Char('/');
+    QStringList removed;
+
+    for (auto &indexed : m_index.keys())
+    {
+        if (indexed != dir && !indexed.startsWith(prefix))
+            continue;
+
+        for (auto &name : m_index.value(indexed).keys())
+            removed.append(indexed + QLatin1Char('/') + name);
+
+        m_watcher.removePath(indexed);
+        m_index.remove(indexed);
+    }
+
+    m_count -= removed.count();
+
+    if (!removed.isEmpty())
+        emit filesRemoved(removed);
+}
+
+QStringList FolderIndexer::nameFilters()
+{
+    static QStringList filters;
+
+    if (filters.isEmpty())
+        for (auto format : QImageReader::supportedImageFormats())
+            filters.append(QStringLiteral("*.") + QString::fromLatin1(format));
+
+    return filters;
+}
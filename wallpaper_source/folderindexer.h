@@ -0,0 +1,68 @@
+#ifndef FOLDERINDEXER_H
+#define FOLDERINDEXER_H
+
+#include <QAtomicInt>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+// 文件夹索引：后台扫描目录中的图片，之后通过 QFileSystemWatcher 只重新列出发生变化的目录，增量通知增删改名
+class FolderIndexer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry
+    {
+        QString name;
+        qint64 size;
+        qint64 modified;
+    };
+
+    explicit FolderIndexer(QObject *parent = nullptr);
+    ~FolderIndexer();
+
+    void setDirectory(const QString &dir);
+    QString directory() const;
+    void clear();
+
+    int count() const;
+    bool isIndexing() const;
+
+signals:
+    void filesAdded(const QStringList &files);
+    void filesRemoved(const QStringList &files);
+    void fileRenamed(const QString &oldPath, const QString &newPath);
+    void indexingFinished(int count);
+
+private slots:
+    void onDirectoryChanged(const QString &dir);
+    void onRelistTimeout();
+
+private:
+    void scan(const QString &root);
+    void relist(const QString &dir);
+    void applyListing(const QString &dir, const QVector<Entry> &entries, const QStringList &subDirs, bool recurse);
+    void removeSubtree(const QString &dir);
+
+    static QStringList nameFilters();
+
+private:
+    QThreadPool m_pool;
+    QFileSystemWatcher m_watcher;
+    QTimer m_relistTimer;
+    QSet<QString> m_changedDirs;                // 合并短时间内的多次变化通知
+
+    QString m_root;
+    QHash<QString, QHash<QString, Entry>> m_index;   // 目录 -> 文件名 -> 文件信息
+    QAtomicInt m_generation;
+    int m_count = 0;
+    int m_runningScans = 0;
+};
+
+#endif // FOLDERINDEXER_H
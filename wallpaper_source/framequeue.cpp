@@ -0,0 +1,78 @@
+#include "framequeue.h"
+
+FrameQueue::FrameQueue(int capacity) : m_capacity(qMax(1, capacity))
+{
+}
+
+bool FrameQueue::push(const Frame &frame)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (!m_closed && m_frames.size() >= m_capacity)
+        m_notFull.wait(&m_mutex);
+
+    if (m_closed)
+        return false;
+
+    m_frames.enqueue(frame);
+    return true;
+}
+
+bool FrameQueue::tryPop(Frame *frame)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_frames.isEmpty())
+        return false;
+
+    *frame = m_frames.dequeue();
+    m_notFull.wakeOne();
+
+    return true;
+}
+
+bool FrameQueue::peekTimestamp(qint64 *timestamp) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_frames.isEmpty())
+        return false;
+
+    *timestamp = m_frames.head().timestamp;
+    return true;
+}
+
+void FrameQueue::close()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_closed = true;
+    m_notFull.wakeAll();
+}
+
+void FrameQueue::reset()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_frames.clear();
+    m_closed = false;
+}
+
+int FrameQueue::count() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_frames.size();
+}
+
+int FrameQueue::capacity() const
+{
+    return m_capacity;
+}
+
+bool FrameQueue::isClosed() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_closed;
+}
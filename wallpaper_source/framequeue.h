@@ -0,0 +1,41 @@
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+#include "framestore.h"
+
+// 解码线程与界面线程之间的有界帧队列：队列满时解码线程等待，界面线程取帧从不阻塞
+class FrameQueue
+{
+public:
+    struct Frame
+    {
+        FrameStore::Delta delta;                // 相对上一帧的变化区域
+        qint64 timestamp;                       // 显示时刻，毫秒，从解码开始时计
+    };
+
+    explicit FrameQueue(int capacity = 4);
+
+    bool push(const Frame &frame);
+    bool tryPop(Frame *frame);
+    bool peekTimestamp(qint64 *timestamp) const;
+
+    void close();
+    void reset();
+
+    int count() const;
+    int capacity() const;
+    bool isClosed() const;
+
+private:
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QQueue<Frame> m_frames;
+    int m_capacity;
+    bool m_closed = false;                      // 关闭后 push 立即返回，解码线程得以退出
+};
+
+#endif // FRAMEQUEUE_H
@@ -0,0 +1,154 @@
+#include "framestore.h"
+
+#include <cstring>
+
+#include "imageresampler.h"
+#include "palettecodec.h"
+
+namespace
+{
+FrameStore::Delta makeDelta(const QRect &rect, const QImage &patch, int delay)
+{
+    FrameStore::Delta delta;
+    delta.rect  = rect;
+    delta.patch = patch;
+    delta.delay = delay;
+
+    return delta;
+}
+}
+
+FrameStore::Delta FrameStore::diff(const QImage &previous, const QImage &current, int delay)
+{
+    if (previous.isNull() || previous.size() != current.size() || previous.format() != current.format())
+        return makeDelta(current.rect(), current, delay);
+
+    const int width  = current.width();
+    const int height = current.height();
+    const size_t bytes = size_t(width) * 4;
+
+    // 先逐行比较找出上下边界，再只在这些行内逐像素收缩左右边界
+    int top = 0;
+    while (top < height && std::memcmp(previous.constScanLine(top), current.constScanLine(top), bytes) == 0)
+        ++top;
+
+    if (top == height)
+        return makeDelta(QRect(), QImage(), delay);
+
+    int bottom = height - 1;
+    while (bottom > top && std::memcmp(previous.constScanLine(bottom), current.constScanLine(bottom), bytes) == 0)
+        --bottom;
+
+    int left  = width;
+    int right = -1;
+
+    for (int y = top; y <= bottom; ++y)
+    {
+        const quint32 *a = reinterpret_cast<const quint32*>(previous.constScanLine(y));
+        const quint32 *b = reinterpret_cast<const quint32*>(current.constScanLine(y));
+
+        int x = 0;
+        while (x < left && a[x] == b[x])
+            ++x;
+        left = qMin(left, x);
+
+        x = width - 1;
+        while (x > right && a[x] == b[x])
+            --x;
+        right = qMax(right, x);
+    }
+
+    const QRect rect(left, top, right - left + 1, bottom - top + 1);
+
+    return makeDelta(rect, current.copy(rect), delay);
+}
+
+bool FrameStore::pack(Delta *delta, const QImage &previous, const QImage &current, const QSize &size)
+{
+    const Delta change = diff(previous, current, delta->delay);
+
+    // 源图不变时缩放结果也不变，无需保存
+    if (change.rect.isEmpty())
+        return true;
+
+    const QByteArray packed = PaletteCodec::pack(change.patch);
+    if (packed.isEmpty())
+        return false;
+
+    delta->rect   = ImageResampler::mapRect(current.size(), size, change.rect);
+    delta->patch  = QImage();
+    delta->packed = packed;
+    delta->source = change.rect;
+
+    return true;
+}
+
+bool FrameStore::expand(const Delta &delta, const QSize &size, QImage *canvas, QImage *patch)
+{
+    if (!PaletteCodec::unpack(delta.packed, patch) || patch->size() != delta.source.size())
+        return false;
+
+    // 每轮第一个压缩帧总是整帧，画布在此时建立
+    if (canvas->isNull() || !canvas->rect().contains(delta.source))
+        *canvas = QImage(delta.source.size(), QImage::Format_ARGB32_Premultiplied);
+
+    for (int y = 0; y < delta.source.height(); ++y)
+        std::memcpy(canvas->scanLine(delta.source.top() + y) + delta.source.left() * 4,
+               patch->constScanLine(y), size_t(delta.source.width()) * 4);
+
+    // 未指定尺寸时帧按源尺寸播放
+    *patch = ImageResampler::scaledRect(*canvas, size.isValid() ? size : canvas->size(), delta.rect);
+
+    return !patch->isNull();
+}
+
+void FrameStore::append(const Delta &delta)
+{
+    m_frames.append(delta);
+    m_bytes += delta.sizeInBytes();
+}
+
+void FrameStore::setLoopDelta(const Delta &delta)
+{
+    m_loop = delta;
+    m_bytes += delta.sizeInBytes();
+    m_complete = true;
+}
+
+void FrameStore::clear()
+{
+    m_frames.clear();
+    m_loop = Delta();
+    m_complete = false;
+    m_bytes = 0;
+}
+
+bool FrameStore::isComplete() const
+{
+    return m_complete;
+}
+
+bool FrameStore::isEmpty() const
+{
+    return m_frames.isEmpty();
+}
+
+int FrameStore::count() const
+{
+    return m_frames.count();
+}
+
+const FrameStore::Delta &FrameStore::at(int index) const
+{
+    return m_frames.at(index);
+}
+
+const FrameStore::Delta &FrameStore::loopDelta() const
+{
+    return m_loop;
+}
+
+qint64 FrameStore::sizeInBytes() const
+{
+    return m_bytes;
+}
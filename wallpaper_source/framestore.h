@@ -0,0 +1,55 @@
+#ifndef FRAMESTORE_H
+#define FRAMESTORE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+// 预先解码的动画帧：第一帧完整保存，之后每帧只保存相对上一帧变化的矩形区域
+// 每帧可以是原始像素，也可以是源分辨率的调色板下标，显示时再缩放到屏幕尺寸，同一缓存中两者可以混合
+class FrameStore
+{
+public:
+    struct Delta
+    {
+        QRect rect;                             // 变化区域，画面不变时为空
+        QImage patch;                           // 该区域的像素，尺寸与 rect 相同，压缩存储时为空
+        int delay = 0;                          // 本帧显示时长，毫秒
+        QByteArray packed;                      // 压缩存储的源分辨率区域，见 PaletteCodec
+        QRect source;                           // packed 在源图中的位置
+
+        qint64 sizeInBytes() const
+        {
+            return patch.sizeInBytes() + packed.size();
+        }
+    };
+
+    static Delta diff(const QImage &previous, const QImage &current, int delay);
+
+    // 把 delta 改为压缩存储：保存源图 current 相对 previous 的变化，previous 为空时保存整帧
+    // delta 的区域改为缩放到 size 后受影响的区域；源图颜色超过 256 种时返回 false，delta 不变
+    static bool pack(Delta *delta, const QImage &previous, const QImage &current, const QSize &size);
+
+    // 压缩帧先写入源分辨率的画布，再从画布缩放出 delta.rect 的像素
+    static bool expand(const Delta &delta, const QSize &size, QImage *canvas, QImage *patch);
+
+    void append(const Delta &delta);
+    void setLoopDelta(const Delta &delta);
+    void clear();
+
+    bool isComplete() const;
+    bool isEmpty() const;
+    int count() const;
+    const Delta &at(int index) const;
+    const Delta &loopDelta() const;
+    qint64 sizeInBytes() const;
+
+private:
+    QVector<Delta> m_frames;
+    Delta m_loop;                               // 最后一帧回到第一帧的变化
+    bool m_complete = false;
+    qint64 m_bytes = 0;
+};
+
+#endif // FRAMESTORE_H
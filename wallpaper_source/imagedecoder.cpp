@@ -0,0 +1,243 @@
+#include "imagedecoder.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImageReader>
+#include <QRunnable>
+#include <QThread>
+
+#include <functional>
+
+#include "contenthash.h"
+#include "imageresampler.h"
+#include "mediaregistry.h"
+#include "resolutionvariants.h"
+#include "wallpapercache.h"
+
+namespace
+{
+class DecodeTask : public QRunnable
+{
+public:
+    DecodeTask(std::shared_ptr<QAtomicInt> started, std::function<void()> func)
+        : m_started(std::move(started)), m_func(std::move(func))
+    { }
+
+    void run() override
+    {
+        m_started->storeRelease(1);
+        m_func();
+    }
+
+private:
+    std::shared_ptr<QAtomicInt> m_started;
+    std::function<void()> m_func;
+};
+
+// 选择不小于目标尺寸的最小 DCT 缩放结果，libjpeg 直接输出该尺寸，不再经过 Qt 的二次缩放
+// Qt 的 JPEG 插件按 min(宽 / 请求宽, 高 / 请求高) 整除选择分母，请求向下取整的尺寸才能恰好选中该分母
+QSize dctScaledSize(const QSize &source, const QSize &target)
+{
+    for (int denom = 8; denom > 1; denom /= 2)
+    {
+        QSize size(source.width() / denom, source.height() / denom);
+        if (size.width() >= target.width() && size.height() >= target.height())
+            return size;
+    }
+
+    return source;
+}
+}
+
+ImageDecoder::ImageDecoder(QObject *parent) : QObject(parent)
+{
+    // 保留一个核心给界面线程
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+ImageDecoder::~ImageDecoder()
+{
+    cancelAll();
+    m_pool.waitForDone();
+}
+
+void ImageDecoder::setTargetSize(const QSize &size, qreal devicePixelRatio)
+{
+    m_targetSize = size;
+    m_devicePixelRatio = devicePixelRatio;
+}
+
+QSize ImageDecoder::targetSize() const
+{
+    return m_targetSize;
+}
+
+int ImageDecoder::decodeEstimate() const
+{
+    return m_decodeEstimate;
+}
+
+int ImageDecoder::decode(const QString &path, Priority priority, const QStringList &variants)
+{
+    int id = m_nextId++;
+    auto started = std::make_shared<QAtomicInt>(0);
+    QSize targetSize = m_targetSize;
+    qreal devicePixelRatio = m_devicePixelRatio;
+
+    DecodeTask *task = new DecodeTask(started, [=](){
+        QElapsedTimer timer;
+        timer.start();
+
+        // 有多种分辨率时在工作线程中读取各版本的文件头，只解码最合适的一个
+        const QString file = variants.isEmpty() ? path : ResolutionVariants::select(variants, targetSize);
+        MediaRegistry::Kind kind = MediaRegistry::ImageKind;
+        QImage image = decodeFile(file, targetSize, devicePixelRatio, true, &kind);
+        int elapsed = int(timer.elapsed());
+
+        QMetaObject::invokeMethod(this, [=](){
+            onTaskFinished(id, path, image, kind, elapsed);
+        }, Qt::QueuedConnection);
+    });
+
+    m_tasks.insert(id, { task, started, false });
+    m_pool.start(task, priority);
+
+    return id;
+}
+
+void ImageDecoder::promote(int id)
+{
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end())
+        return;
+
+    // 仍在队列中的任务重新以高优先级入队，已开始解码的任务不受影响
+    if (takeQueued(*it))
+        m_pool.start(it->runnable, NextSlidePriority);
+}
+
+void ImageDecoder::cancel(int id)
+{
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end())
+        return;
+
+    if (takeQueued(*it))
+    {
+        delete it->runnable;
+        m_tasks.erase(it);
+    }
+    else
+    {
+        it->canceled = true;
+    }
+}
+
+void ImageDecoder::cancelAll()
+{
+    for (auto id : m_tasks.keys())
+        cancel(id);
+}
+
+bool ImageDecoder::takeQueued(const Task &task)
+{
+    return task.started->loadAcquire() == 0 && m_pool.tryTake(task.runnable);
+}
+
+void ImageDecoder::onTaskFinished(int id, const QString &path, const QImage &image, MediaRegistry::Kind kind, int elapsed)
+{
+    // 慢的解码立即抬高估计值，之后逐次衰减
+    m_decodeEstimate = qMax(elapsed, m_decodeEstimate * 7 / 8);
+
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end())
+        return;
+
+    bool canceled = it->canceled;
+    m_tasks.erase(it);
+
+    if (!canceled)
+        emit decoded(id, path, image, kind);
+}
+
+QImage ImageDecoder::decodeFile(const QString &path, const QSize &targetSize, qreal devicePixelRatio, bool cached,
+                                MediaRegistry::Kind *kind)
+{
+    WallpaperCache *cache = WallpaperCache::instance();
+    quint64 hash = 0;
+
+    // 不经过缓存的解码（例如平移缩放用的高分辨率画面）不查询也不写入磁盘缓存
+    cached = cached && targetSize.isValid();
+
+    // 已经算过内容哈希的文件（包括之前几次运行中算过的）不必读取即可查询缓存
+    const bool known = cached && cache->knownHash(path, &hash);
+    if (known)
+    {
+        QImage hit = cache->lookup(path, hash, targetSize);
+        if (!hit.isNull())
+            return hit;
+    }
+
+    // 按文件内容而不是扩展名选择解码器，视频等无法解码为单张图片的条目直接跳过
+    const MediaRegistry::Handler &handler = MediaRegistry::handlerForFile(path);
+
+    // 需要类型的调用方（轮播）自己播放动画和视频，不把动画解码为单张图片
+    if (kind != nullptr)
+    {
+        *kind = handler.kind;
+        if (handler.kind != MediaRegistry::ImageKind)
+            return QImage();
+    }
+
+    if (!(handler.capabilities & MediaRegistry::StillImage))
+        return QImage();
+
+    // 读取文件的同时计算内容哈希，内容相同的文件命中同一份缓存；读入的数据直接用于解码
+    QByteArray data = ContentHash::readFile(path, &hash);
+    if (data.isEmpty())
+        return QImage();
+
+    if (cached && !known)
+    {
+        cache->rememberHash(path, hash);
+
+        QImage hit = cache->lookup(path, hash, targetSize);
+        if (!hit.isNull())
+            return hit;
+    }
+
+    QBuffer buffer(&data);
+    QImageReader reader(&buffer, handler.readerFormat);
+    reader.setAutoTransform(true);
+
+    // JPEG 在 DCT 阶段按 1/2、1/4、1/8 缩小解码，旋转 90 度的图片先按旋转前的方向计算尺寸
+    if (targetSize.isValid() && (handler.capabilities & MediaRegistry::ScaledDecode) && reader.size().isValid())
+    {
+        bool transposed = reader.transformation() & QImageIOHandler::TransformationRotate90;
+        QSize scaledSize = dctScaledSize(reader.size(), transposed ? targetSize.transposed() : targetSize);
+
+        if (scaledSize != reader.size())
+            reader.setScaledSize(scaledSize);
+    }
+
+    QImage image = reader.read();
+    if (image.isNull())
+        return image;
+
+    // 剩余的缩放统一由高质量重采样完成，显示时只需原样拷贝
+    if (targetSize.isValid() && image.size() != targetSize)
+        image = ImageResampler::scaled(image, targetSize);
+
+    // 在工作线程中完成格式转换，界面线程拷贝到壁纸缓冲时无需再逐像素转换
+    QImage::Format format = image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    if (image.format() != format)
+        image = image.convertToFormat(format);
+
+    image.setDevicePixelRatio(devicePixelRatio);
+
+    // 同时解码了相同内容时返回先存入的那一份，两者共用同一块内存
+    if (cached)
+        image = cache->store(path, hash, targetSize, image);
+
+    return image;
+}
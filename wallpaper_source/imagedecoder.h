@@ -0,0 +1,70 @@
+#ifndef IMAGEDECODER_H
+#define IMAGEDECODER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <memory>
+
+#include "mediaregistry.h"
+
+class QRunnable;
+
+// 后台图片解码服务：在工作线程中解码为 QImage，结果通过队列连接回到界面线程
+class ImageDecoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority
+    {
+        PrefetchPriority  = 0,                  // 后台预取
+        NextSlidePriority = 10                  // 即将显示的图片
+    };
+
+    explicit ImageDecoder(QObject *parent = nullptr);
+    ~ImageDecoder();
+
+    void setTargetSize(const QSize &size, qreal devicePixelRatio = 1.0);
+    QSize targetSize() const;
+    int decodeEstimate() const;
+
+    int decode(const QString &path, Priority priority = PrefetchPriority, const QStringList &variants = QStringList());
+    void promote(int id);
+    void cancel(int id);
+    void cancelAll();
+
+    static QImage decodeFile(const QString &path, const QSize &targetSize, qreal devicePixelRatio, bool cached = true,
+                             MediaRegistry::Kind *kind = nullptr);
+
+signals:
+    void decoded(int id, const QString &path, const QImage &image, MediaRegistry::Kind kind);
+
+private:
+    void onTaskFinished(int id, const QString &path, const QImage &image, MediaRegistry::Kind kind, int elapsed);
+
+private:
+    struct Task
+    {
+        QRunnable *runnable;
+        std::shared_ptr<QAtomicInt> started;    // 任务开始运行后 runnable 由线程池负责释放
+        bool canceled;
+    };
+
+    bool takeQueued(const Task &task);
+
+    QThreadPool m_pool;
+    QHash<int, Task> m_tasks;
+    QSize m_targetSize;                         // 物理像素尺寸，为空时按原始尺寸解码
+    qreal m_devicePixelRatio = 1.0;
+    int m_nextId = 1;
+    int m_decodeEstimate = 0;                   // 近期解码耗时的衰减最大值，毫秒
+};
+
+#endif // IMAGEDECODER_H
@@ -0,0 +1,287 @@
+#include "imageresampler.h"
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <cmath>
+
+#include "pixelkernels.h"
+
+namespace
+{
+struct Coefficients
+{
+    int taps;
+    QVector<int> bounds;                        // 每个输出像素的 [起始下标, 采样数]
+    QVector<qint16> weights;
+};
+
+struct Band
+{
+    int begin;
+    int end;
+};
+
+double sinc(double x)
+{
+    if (x == 0.0)
+        return 1.0;
+
+    x *= M_PI;
+    return std::sin(x) / x;
+}
+
+double filterWeight(ImageResampler::Filter filter, double x)
+{
+    if (filter == ImageResampler::AreaFilter)
+        return x > -0.5 && x <= 0.5 ? 1.0 : 0.0;
+
+    return x > -3.0 && x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+}
+
+Coefficients computeCoefficients(int inSize, int outSize, ImageResampler::Filter filter)
+{
+    const double support0    = filter == ImageResampler::AreaFilter ? 0.5 : 3.0;
+    const double scale       = double(inSize) / outSize;
+    const double filterScale = qMax(scale, 1.0);
+    const double support     = support0 * filterScale;
+    const int one            = 1 << PixelKernels::WeightBits;
+
+    Coefficients c;
+    c.taps = int(std::ceil(support)) * 2 + 1;
+    c.bounds.resize(outSize * 2);
+    c.weights.fill(0, outSize * c.taps);
+
+    QVector<double> k(c.taps);
+
+    for (int xx = 0; xx < outSize; ++xx)
+    {
+        const double center = (xx + 0.5) * scale;
+        const int xmin  = qBound(0, int(center - support + 0.5), inSize - 1);
+        const int xmax  = qBound(xmin + 1, int(center + support + 0.5), inSize);
+        const int count = qMin(xmax - xmin, c.taps);
+        qint16 *w = c.weights.data() + xx * c.taps;
+
+        double total = 0.0;
+        int largest  = 0;
+        for (int x = 0; x < count; ++x)
+        {
+            k[x] = filterWeight(filter, (x + xmin - center + 0.5) / filterScale);
+            total += k[x];
+            if (std::fabs(k[x]) > std::fabs(k[largest]))
+                largest = x;
+        }
+
+        // 定点化后的舍入误差全部计入最大的权重，保证权重之和严格为 1
+        int sum = 0;
+        for (int x = 0; x < count; ++x)
+        {
+            w[x] = total != 0.0 ? qint16(qRound(k[x] / total * one)) : qint16(0);
+            sum += w[x];
+        }
+        w[largest] = qint16(w[largest] + one - sum);
+
+        c.bounds[2 * xx]     = xmin;
+        c.bounds[2 * xx + 1] = count;
+    }
+
+    return c;
+}
+
+// 源下标 [begin, end) 变化时可能受影响的输出下标，按滤波器支撑范围放宽一个像素
+void mapRange(int begin, int end, int inSize, int outSize, ImageResampler::Filter filter, int *outBegin, int *outEnd)
+{
+    if (inSize == outSize)
+    {
+        *outBegin = begin;
+        *outEnd   = end;
+        return;
+    }
+
+    const double support0 = filter == ImageResampler::AreaFilter ? 0.5 : 3.0;
+    const double scale    = double(inSize) / outSize;
+    const double support  = support0 * qMax(scale, 1.0);
+
+    *outBegin = qBound(0, int(std::floor((begin - support - 0.5) / scale - 0.5)) - 1, outSize);
+    *outEnd   = qBound(0, int(std::ceil((end + support + 0.5) / scale - 0.5)) + 1, outSize);
+}
+
+QVector<Band> splitBands(int rows, int threadCount)
+{
+    // 每段至少 16 行，避免线程调度开销超过计算量
+    const int bandCount = qBound(1, rows / 16, threadCount);
+    QVector<Band> bands;
+
+    for (int i = 0; i < bandCount; ++i)
+        bands.append({ rows * i / bandCount, rows * (i + 1) / bandCount });
+
+    return bands;
+}
+}
+
+QImage ImageResampler::scaled(const QImage &image, const QSize &size, Filter filter, int threadCount)
+{
+    if (image.isNull() || size.isEmpty())
+        return QImage();
+
+    const QImage::Format format = image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    const QImage src = image.format() == format ? image : image.convertToFormat(format);
+
+    if (src.size() == size)
+        return src;
+
+    if (threadCount <= 0)
+        threadCount = QThread::idealThreadCount();
+
+    const bool premultiplied = format == QImage::Format_ARGB32_Premultiplied;
+
+    // 水平方向：逐行处理全部源行；缩小时垂直方向的滤波窗口覆盖每一行源像素，按需处理省不下工作量，只缩放局部时见 scaledRect()
+    QImage horizontal = src;
+    if (src.width() != size.width())
+    {
+        const Coefficients c = computeCoefficients(src.width(), size.width(), filter);
+        horizontal = QImage(size.width(), src.height(), format);
+        horizontal.setDevicePixelRatio(image.devicePixelRatio());
+
+        // 先取出可写指针，工作线程中不再调用可能触发分离的 scanLine()
+        uchar *bits = horizontal.bits();
+        const int stride = horizontal.bytesPerLine();
+        QVector<Band> bands = splitBands(src.height(), threadCount);
+
+        QtConcurrent::blockingMap(bands, [&](const Band &band){
+            for (int y = band.begin; y < band.end; ++y)
+            {
+                quint32 *out = reinterpret_cast<quint32*>(bits + y * stride);
+                PixelKernels::resampleHorizontal(reinterpret_cast<const quint32*>(src.constScanLine(y)), out,
+                                                 size.width(), c.bounds.constData(), c.weights.constData(), c.taps);
+                if (premultiplied)
+                    PixelKernels::clampPremultiplied(out, size.width());
+            }
+        });
+    }
+
+    if (horizontal.height() == size.height())
+        return horizontal;
+
+    const Coefficients c = computeCoefficients(horizontal.height(), size.height(), filter);
+    QImage dst(size, format);
+    uchar *bits = dst.bits();
+    const int stride = dst.bytesPerLine();
+    QVector<Band> bands = splitBands(size.height(), threadCount);
+
+    QtConcurrent::blockingMap(bands, [&](const Band &band){
+        for (int y = band.begin; y < band.end; ++y)
+        {
+            quint32 *out = reinterpret_cast<quint32*>(bits + y * stride);
+            PixelKernels::resampleVertical(horizontal.constScanLine(c.bounds[2 * y]), horizontal.bytesPerLine(), out,
+                                           size.width(), c.bounds[2 * y + 1], c.weights.constData() + y * c.taps);
+            if (premultiplied)
+                PixelKernels::clampPremultiplied(out, size.width());
+        }
+    });
+
+    dst.setDevicePixelRatio(image.devicePixelRatio());
+    return dst;
+}
+
+QImage ImageResampler::scaledRect(const QImage &image, const QSize &size, const QRect &rect, Filter filter, int threadCount)
+{
+    const QRect target = rect & QRect(QPoint(0, 0), size);
+    if (image.isNull() || target.isEmpty())
+        return QImage();
+
+    const QImage::Format format = image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    const QImage src = image.format() == format ? image : image.convertToFormat(format);
+
+    if (src.size() == size)
+        return src.copy(target);
+
+    if (threadCount <= 0)
+        threadCount = QThread::idealThreadCount();
+
+    const bool premultiplied = format == QImage::Format_ARGB32_Premultiplied;
+    const bool vertical = src.height() != size.height();
+
+    // 系数按整幅图计算，只取目标区域对应的部分，因此结果与整幅缩放完全一致
+    Coefficients cv;
+    int rowBegin = target.top();
+    int rowEnd   = target.bottom() + 1;
+
+    if (vertical)
+    {
+        cv = computeCoefficients(src.height(), size.height(), filter);
+        rowBegin = src.height();
+        rowEnd   = 0;
+        for (int y = target.top(); y <= target.bottom(); ++y)
+        {
+            rowBegin = qMin(rowBegin, cv.bounds[2 * y]);
+            rowEnd   = qMax(rowEnd, cv.bounds[2 * y] + cv.bounds[2 * y + 1]);
+        }
+    }
+
+    // 水平方向：只处理垂直方向会用到的源行，只输出目标区域的列
+    QImage horizontal;
+    if (src.width() != size.width())
+    {
+        const Coefficients c = computeCoefficients(src.width(), size.width(), filter);
+        horizontal = QImage(target.width(), rowEnd - rowBegin, format);
+
+        uchar *bits = horizontal.bits();
+        const int stride = horizontal.bytesPerLine();
+        QVector<Band> bands = splitBands(horizontal.height(), threadCount);
+
+        QtConcurrent::blockingMap(bands, [&](const Band &band){
+            for (int y = band.begin; y < band.end; ++y)
+            {
+                quint32 *out = reinterpret_cast<quint32*>(bits + y * stride);
+                PixelKernels::resampleHorizontal(reinterpret_cast<const quint32*>(src.constScanLine(rowBegin + y)), out,
+                                                 target.width(), c.bounds.constData() + 2 * target.left(),
+                                                 c.weights.constData() + target.left() * c.taps, c.taps);
+                if (premultiplied)
+                    PixelKernels::clampPremultiplied(out, target.width());
+            }
+        });
+    }
+    else
+    {
+        horizontal = src.copy(target.left(), rowBegin, target.width(), rowEnd - rowBegin);
+    }
+
+    if (!vertical)
+        return horizontal;
+
+    QImage dst(target.size(), format);
+    uchar *bits = dst.bits();
+    const int stride = dst.bytesPerLine();
+    QVector<Band> bands = splitBands(target.height(), threadCount);
+
+    QtConcurrent::blockingMap(bands, [&](const Band &band){
+        for (int y = band.begin; y < band.end; ++y)
+        {
+            const int row = target.top() + y;
+            quint32 *out = reinterpret_cast<quint32*>(bits + y * stride);
+            PixelKernels::resampleVertical(horizontal.constScanLine(cv.bounds[2 * row] - rowBegin), horizontal.bytesPerLine(), out,
+                                           target.width(), cv.bounds[2 * row + 1], cv.weights.constData() + row * cv.taps);
+            if (premultiplied)
+                PixelKernels::clampPremultiplied(out, target.width());
+        }
+    });
+
+    return dst;
+}
+
+QRect ImageResampler::mapRect(const QSize &from, const QSize &to, const QRect &rect, Filter filter)
+{
+    if (rect.isEmpty() || from.isEmpty() || to.isEmpty())
+        return QRect();
+
+    int left   = 0;
+    int right  = 0;
+    int top    = 0;
+    int bottom = 0;
+    mapRange(rect.left(), rect.right() + 1, from.width(), to.width(), filter, &left, &right);
+    mapRange(rect.top(), rect.bottom() + 1, from.height(), to.height(), filter, &top, &bottom);
+
+    return QRect(left, top, right - left, bottom - top);
+}
@@ -0,0 +1,29 @@
+#ifndef IMAGERESAMPLER_H
+#define IMAGERESAMPLER_H
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+
+// 可分离的高质量缩放：先水平后垂直，两遍都按行分段在线程池中并行，内核按 CPU 支持选择 SIMD 实现
+class ImageResampler
+{
+public:
+    enum Filter
+    {
+        AreaFilter,                             // 面积平均，缩小时速度最快
+        LanczosFilter                           // Lanczos3，锐利且无明显锯齿
+    };
+
+    static QImage scaled(const QImage &image, const QSize &size,
+                         Filter filter = LanczosFilter, int threadCount = 0);
+
+    // 只计算缩放结果中 rect 内的像素，与 scaled(image, size).copy(rect) 逐像素相同
+    static QImage scaledRect(const QImage &image, const QSize &size, const QRect &rect,
+                             Filter filter = LanczosFilter, int threadCount = 0);
+
+    // 源图中 rect 内的像素变化时，缩放到 size 的结果中可能随之变化的区域
+    static QRect mapRect(const QSize &from, const QSize &to, const QRect &rect, Filter filter = LanczosFilter);
+};
+
+#endif // IMAGERESAMPLER_H
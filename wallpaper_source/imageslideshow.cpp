@@ -0,0 +1,692 @@
+#include "imageslideshow.h"
+
+#include <QElapsedTimer>
+#include <QSet>
+
+#include <algorithm>
+
+#include "resolutionvariants.h"
+
+namespace
+{
+// 每批处理的播放列表条目数，一批在界面线程上只占几毫秒
+const int GroupBatch = 1000;
+}
+
+ImageSlideshow::ImageSlideshow(QObject *parent) : QObject(parent)
+{
+    m_groupTimer.setSingleShot(true);
+
+    connect(m_pDecoder, &ImageDecoder::decoded, this, &ImageSlideshow::onDecoded);
+    connect(&m_groupTimer, &QTimer::timeout, this, &ImageSlideshow::groupPlaylist);
+
+    MemoryBudget::instance()->registerConsumer(this);
+}
+
+ImageSlideshow::~ImageSlideshow()
+{
+    MemoryBudget::instance()->unregisterConsumer(this);
+}
+
+void ImageSlideshow::setFiles(const QStringList &files)
+{
+    clear();
+    m_files = groupVariants(files);
+}
+
+void ImageSlideshow::setPlaylist(const Playlist *playlist)
+{
+    // 条目在用到时才从播放列表中读取，下标即播放列表中的下标；分辨率分组在空闲时分批完成，不推迟第一张图片
+    clear();
+    m_pPlaylist = playlist;
+    m_groupTimer.start(0);
+}
+
+void ImageSlideshow::addFiles(const QStringList &files)
+{
+    // 新文件追加在末尾，已有条目的下标不变，当前图片和预取窗口不受影响
+    const bool wasEmpty = m_files.isEmpty();
+
+    m_files.append(groupVariants(files));
+
+    if (!wasEmpty)
+    {
+        trimWindow();
+        prefetch();
+    }
+}
+
+void ImageSlideshow::removeFiles(const QStringList &files)
+{
+    if (files.isEmpty() || m_files.isEmpty())
+        return;
+
+    // 同组还有其他分辨率的文件时条目保留，只从分组中去掉
+    QStringList entries;
+    for (auto &file : files)
+    {
+        if (!removeVariant(file))
+            entries.append(file);
+        m_media.remove(file);
+    }
+
+    // 一次遍历生成新列表和旧下标到新下标的映射，删除的条目映射为 -1
+    const QSet<QString> removed(entries.begin(), entries.end());
+    QStringList remaining;
+    QVector<int> map(m_files.count(), -1);
+
+    for (int i = 0; i < m_files.count(); ++i)
+    {
+        if (removed.contains(m_files.at(i)))
+            continue;
+
+        map[i] = remaining.count();
+        remaining.append(m_files.at(i));
+    }
+
+    if (remaining.count() == m_files.count())
+        return;
+
+    // 当前图片被删除时继续显示，把当前位置退到它之前仍保留的条目，下次切换即到它之后的第一张
+    const int n = m_files.count();
+    int current = -1;
+
+    for (int i = 0; i < n && current == -1; ++i)
+        current = map.at(((m_currentIndex - i) % n + n) % n);
+
+    QHash<int, int> pending;
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it)
+    {
+        if (map.at(it.key()) != -1)
+            pending.insert(map.at(it.key()), it.value());
+        else
+            m_pDecoder->cancel(it.value());
+    }
+
+    m_window = remapWindow(map);
+    m_files  = remaining;
+    m_upcomingIndex = m_upcomingIndex != -1 ? map.at(m_upcomingIndex) : -1;
+    m_pending.clear();
+    m_requests.clear();
+
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it)
+    {
+        m_pending.insert(it.key(), it.value());
+        m_requests.insert(it.value(), it.key());
+    }
+
+    if (m_files.isEmpty())
+    {
+        m_currentIndex = 0;
+        m_targetIndex  = -1;
+        return;
+    }
+
+    m_currentIndex = current;
+
+    if (m_targetIndex != -1)
+    {
+        m_targetIndex = map.at(m_targetIndex) != -1 ? map.at(m_targetIndex) : wrap(m_currentIndex + 1);
+        m_failures    = 0;
+        showTarget();
+    }
+
+    trimWindow();
+    prefetch();
+}
+
+void ImageSlideshow::renameFile(const QString &oldPath, const QString &newPath)
+{
+    // 内容未变，已解码的图片和进行中的解码都继续有效；文件留在原来的分辨率分组中
+    int index = m_files.indexOf(oldPath);
+    if (index != -1)
+        m_files[index] = newPath;
+
+    for (auto it = m_representatives.begin(); it != m_representatives.end(); ++it)
+        if (it.value() == oldPath)
+            it.value() = newPath;
+
+    if (m_variants.contains(oldPath))
+        m_variants.insert(newPath, m_variants.take(oldPath));
+
+    if (m_media.contains(oldPath))
+        m_media.insert(newPath, m_media.take(oldPath));
+
+    for (auto &variants : m_variants)
+    {
+        int position = variants.indexOf(oldPath);
+        if (position != -1)
+            variants[position] = newPath;
+    }
+}
+
+bool ImageSlideshow::isGrouped() const
+{
+    return m_pPlaylist == nullptr || m_grouped >= m_pPlaylist->count();
+}
+
+int ImageSlideshow::count() const
+{
+    return m_pPlaylist != nullptr ? m_pPlaylist->count() : m_files.count();
+}
+
+int ImageSlideshow::duration(int index) const
+{
+    // 只有播放列表能为条目单独指定显示时长，返回 0 表示使用默认时长
+    return m_pPlaylist != nullptr ? m_pPlaylist->duration(index) : 0;
+}
+
+void ImageSlideshow::setTargetSize(const QSize &size, qreal devicePixelRatio)
+{
+    if (size == m_pDecoder->targetSize())
+        return;
+
+    m_pDecoder->setTargetSize(size, devicePixelRatio);
+
+    if (count() == 0)
+        return;
+
+    // 尺寸变化后窗口内的图片全部作废，壁纸窗口保持显示旧图直到按新尺寸解码完成
+    m_pDecoder->cancelAll();
+    m_window.clear();
+    m_pending.clear();
+    m_requests.clear();
+    m_upcomingIndex = -1;
+
+    if (m_targetIndex == -1)
+    {
+        m_targetIndex = m_currentIndex;
+        m_failures    = 0;
+    }
+
+    showTarget();
+}
+
+void ImageSlideshow::setWindow(int lookbehind, int lookahead)
+{
+    m_lookbehind = qMax(0, lookbehind);
+    m_lookahead  = qMax(0, lookahead);
+
+    if (count() == 0)
+        return;
+
+    trimWindow();
+    prefetch();
+}
+
+void ImageSlideshow::setPrefetchEnabled(bool enabled)
+{
+    if (enabled == m_prefetchEnabled)
+        return;
+
+    m_prefetchEnabled = enabled;
+
+    if (count() == 0)
+        return;
+
+    if (enabled)
+    {
+        prefetch();
+        return;
+    }
+
+    // 取消尚未完成的预取，等待显示和即将显示的图片照常解码
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (it.key() == m_targetIndex || it.key() == m_upcomingIndex)
+        {
+            ++it;
+        }
+        else
+        {
+            m_pDecoder->cancel(it.value());
+            m_requests.remove(it.value());
+            it = m_pending.erase(it);
+        }
+    }
+}
+
+bool ImageSlideshow::isPrefetchEnabled() const
+{
+    return m_prefetchEnabled;
+}
+
+int ImageSlideshow::lookbehind() const
+{
+    return m_lookbehind;
+}
+
+int ImageSlideshow::lookahead() const
+{
+    return m_lookahead;
+}
+
+int ImageSlideshow::currentIndex() const
+{
+    return m_currentIndex;
+}
+
+ImageSlideshow::Statistics ImageSlideshow::statistics() const
+{
+    return { m_switches, m_switches > 0 ? m_switchTotal / 1e6 / m_switches : 0.0, m_switchMax / 1e6 };
+}
+
+int ImageSlideshow::decodeEstimate() const
+{
+    return m_pDecoder->decodeEstimate();
+}
+
+QImage ImageSlideshow::currentImage() const
+{
+    return m_window.value(m_currentIndex);
+}
+
+QStringList ImageSlideshow::currentFiles() const
+{
+    // 当前条目的全部分辨率版本，只有一种时即条目本身
+    if (m_currentIndex < 0 || m_currentIndex >= count())
+        return QStringList();
+
+    const QString file = entry(m_currentIndex);
+    return m_variants.value(file, QStringList(file));
+}
+
+bool ImageSlideshow::start()
+{
+    if (count() == 0)
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_currentIndex = 0;
+    m_targetIndex  = 0;
+    m_failures     = 0;
+
+    if (showTarget())
+        recordSwitch(timer.nsecsElapsed());
+
+    return true;
+}
+
+bool ImageSlideshow::next()
+{
+    return count() > 0 && show(wrap(m_currentIndex + 1));
+}
+
+bool ImageSlideshow::show(int index)
+{
+    // 上一次切换仍在等待解码时跳过本次切换
+    if (index < 0 || index >= count() || m_targetIndex != -1)
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_targetIndex = index;
+    m_failures    = 0;
+
+    if (showTarget())
+        recordSwitch(timer.nsecsElapsed());
+
+    return true;
+}
+
+void ImageSlideshow::prefetchIndex(int index)
+{
+    if (index < 0 || index >= count())
+        return;
+
+    m_upcomingIndex = index;
+    request(index, ImageDecoder::NextSlidePriority);
+}
+
+void ImageSlideshow::clear()
+{
+    m_pDecoder->cancelAll();
+    m_groupTimer.stop();
+
+    m_pPlaylist = nullptr;
+    m_files.clear();
+    m_merged.clear();
+    m_grouped = 0;
+    m_representatives.clear();
+    m_variants.clear();
+    m_media.clear();
+    m_window.clear();
+    m_pending.clear();
+    m_requests.clear();
+    m_currentIndex  = 0;
+    m_targetIndex   = -1;
+    m_upcomingIndex = -1;
+}
+
+void ImageSlideshow::onDecoded(int id, const QString &path, const QImage &image, MediaRegistry::Kind kind)
+{
+    // 解码结果交接到显示完成的界面线程耗时，只统计导致切换的结果
+    QElapsedTimer timer;
+    timer.start();
+
+    if (kind == MediaRegistry::MovieKind || kind == MediaRegistry::VideoKind)
+        m_media.insert(path, kind);
+
+    auto it = m_requests.find(id);
+    if (it == m_requests.end())
+        return;
+
+    int index = it.value();
+    m_requests.erase(it);
+    m_pending.remove(index);
+
+    if (!isWanted(index))
+        return;
+
+    // 预算不足时丢弃预取结果，等待显示和即将显示的图片总是保留；与已有条目共用内存的图片不占用预算
+    if (!isShared(image) && !MemoryBudget::instance()->reserve(qint64(image.sizeInBytes()), this)
+            && index != m_targetIndex && index != m_upcomingIndex)
+        return;
+
+    m_window.insert(index, image);
+
+    if (index == m_targetIndex && showTarget())
+        recordSwitch(timer.nsecsElapsed());
+}
+
+QHash<int, QImage> ImageSlideshow::remapWindow(const QVector<int> &map) const
+{
+    QHash<int, QImage> window;
+
+    for (auto it = m_window.constBegin(); it != m_window.constEnd(); ++it)
+        if (map.at(it.key()) != -1)
+            window.insert(map.at(it.key()), it.value());
+
+    return window;
+}
+
+QString ImageSlideshow::entry(int index) const
+{
+    return m_pPlaylist != nullptr ? m_pPlaylist->at(index) : m_files.at(index);
+}
+
+int ImageSlideshow::wrap(int index) const
+{
+    const int n = count();
+
+    return (index % n + n) % n;
+}
+
+bool ImageSlideshow::inWindow(int index) const
+{
+    const int n = count();
+    int forward = wrap(index - m_currentIndex);
+
+    return forward <= m_lookahead || n - forward <= m_lookbehind;
+}
+
+bool ImageSlideshow::isShared(const QImage &image) const
+{
+    for (auto &other : m_window)
+        if (!other.isNull() && other.constBits() == image.constBits())
+            return true;
+
+    return false;
+}
+
+QStringList ImageSlideshow::groupVariants(const QStringList &files)
+{
+    // 返回需要新增的条目，已有分组的其他分辨率版本并入分组
+    QStringList entries;
+
+    for (auto &file : files)
+        if (addVariant(file))
+            entries.append(file);
+
+    return entries;
+}
+
+bool ImageSlideshow::addVariant(const QString &file)
+{
+    const QString key = ResolutionVariants::key(file);
+    auto it = m_representatives.constFind(key);
+    if (it == m_representatives.constEnd())
+    {
+        m_representatives.insert(key, file);
+        return true;
+    }
+
+    QStringList &variants = m_variants[it.value()];
+    if (variants.isEmpty())
+        variants.append(it.value());
+    variants.append(file);
+
+    return false;
+}
+
+void ImageSlideshow::groupPlaylist()
+{
+    // 并入其他条目的分辨率版本保留下标但不再显示，已在窗口中的图片照常淘汰
+    const int end = qMin(m_grouped + GroupBatch, count());
+
+    for (; m_grouped < end; ++m_grouped)
+        if (!addVariant(entry(m_grouped)))
+            m_merged.insert(m_grouped);
+
+    if (m_grouped < count())
+        m_groupTimer.start(0);
+}
+
+bool ImageSlideshow::removeVariant(const QString &path)
+{
+    const QString key = ResolutionVariants::key(path);
+    const QString representative = m_representatives.value(key);
+
+    auto it = m_variants.find(representative);
+    if (it == m_variants.end() || !it->contains(path))
+    {
+        if (representative == path)
+            m_representatives.remove(key);
+        return false;
+    }
+
+    QStringList variants = *it;
+    variants.removeAll(path);
+    m_variants.erase(it);
+
+    // 代表条目被删除时由同组的下一个文件接替，下标和已解码的图片不变
+    if (representative == path)
+    {
+        m_representatives.insert(key, variants.first());
+        renameFile(path, variants.first());
+    }
+
+    if (variants.count() > 1)
+        m_variants.insert(m_representatives.value(key), variants);
+
+    return true;
+}
+
+bool ImageSlideshow::isWanted(int index) const
+{
+    return inWindow(index) || index == m_targetIndex || index == m_upcomingIndex;
+}
+
+void ImageSlideshow::request(int index, ImageDecoder::Priority priority)
+{
+    if (m_window.contains(index) || m_merged.contains(index))
+        return;
+
+    auto it = m_pending.constFind(index);
+    if (it != m_pending.constEnd())
+    {
+        if (priority == ImageDecoder::NextSlidePriority)
+            m_pDecoder->promote(it.value());
+        return;
+    }
+
+    int id = m_pDecoder->decode(entry(index), priority, m_variants.value(entry(index)));
+    m_pending.insert(index, id);
+    m_requests.insert(id, index);
+}
+
+bool ImageSlideshow::showTarget()
+{
+    bool shown = false;
+
+    while (m_targetIndex != -1)
+    {
+        const bool merged = m_merged.contains(m_targetIndex);
+        auto it = m_window.constFind(m_targetIndex);
+        if (!merged && it == m_window.constEnd())
+        {
+            request(m_targetIndex, ImageDecoder::NextSlidePriority);
+            return shown;
+        }
+
+        if (merged || (it.value().isNull() && !m_media.contains(entry(m_targetIndex))))
+        {
+            // 跳过并入其他条目的分辨率版本；全部图片都无法解码时停止尝试
+            m_targetIndex = ++m_failures < count() ? wrap(m_targetIndex + 1) : -1;
+            continue;
+        }
+
+        m_currentIndex = m_targetIndex;
+        m_targetIndex  = -1;
+
+        if (m_currentIndex == m_upcomingIndex)
+            m_upcomingIndex = -1;
+
+        trimWindow();
+        prefetch();
+
+        auto media = m_media.constFind(entry(m_currentIndex));
+        if (media != m_media.constEnd())
+            emit mediaChanged(media.key(), media.value());
+        else
+            emit currentChanged(currentImage());
+
+        shown = true;
+    }
+
+    return shown;
+}
+
+void ImageSlideshow::recordSwitch(qint64 nsecs)
+{
+    m_switches++;
+    m_switchTotal += nsecs;
+    m_switchMax = qMax(m_switchMax, nsecs);
+}
+
+void ImageSlideshow::trimWindow()
+{
+    for (auto it = m_window.begin(); it != m_window.end();)
+    {
+        if (isWanted(it.key()))
+            ++it;
+        else
+            it = m_window.erase(it);
+    }
+
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (isWanted(it.key()))
+        {
+            ++it;
+        }
+        else
+        {
+            m_pDecoder->cancel(it.value());
+            m_requests.remove(it.value());
+            it = m_pending.erase(it);
+        }
+    }
+}
+
+void ImageSlideshow::prefetch()
+{
+    if (!m_prefetchEnabled)
+        return;
+
+    // 只预取预算还能容纳的图片，避免刚被淘汰的图片又被立即重新解码
+    const qint64 bytes = estimatedBytes();
+    qint64 available = MemoryBudget::instance()->available() - bytes * m_pending.count();
+
+    for (int i = 1; i <= m_lookahead + m_lookbehind && available >= bytes; ++i)
+    {
+        int index = wrap(i <= m_lookahead ? m_currentIndex + i : m_currentIndex + m_lookahead - i);
+
+        if (m_window.contains(index) || m_pending.contains(index) || m_merged.contains(index))
+            continue;
+
+        request(index, ImageDecoder::PrefetchPriority);
+        available -= bytes;
+    }
+}
+
+qint64 ImageSlideshow::estimatedBytes() const
+{
+    const QSize size = m_pDecoder->targetSize();
+
+    return size.isValid() ? qint64(size.width()) * size.height() * 4 : 0;
+}
+
+QString ImageSlideshow::memoryName() const
+{
+    return QStringLiteral("image");
+}
+
+qint64 ImageSlideshow::memoryUsage() const
+{
+    // 内容相同的条目共用同一块已解码的内存，只计一次
+    QSet<const uchar*> counted;
+    qint64 total = 0;
+
+    for (auto &image : m_window)
+    {
+        if (!image.isNull() && !counted.contains(image.constBits()))
+        {
+            counted.insert(image.constBits());
+            total += image.sizeInBytes();
+        }
+    }
+
+    return total;
+}
+
+int ImageSlideshow::memoryPriority() const
+{
+    return PrefetchPriority;
+}
+
+qint64 ImageSlideshow::releaseMemory(qint64 bytes)
+{
+    // 最久之前显示过的图片最先淘汰，其次是最远的预取图片；当前图片不淘汰
+    const int n = count();
+    QList<int> order;
+
+    for (auto it = m_window.constBegin(); it != m_window.constEnd(); ++it)
+        if (it.key() != m_currentIndex && it.key() != m_targetIndex && it.key() != m_upcomingIndex)
+            order.append(it.key());
+
+    auto rank = [=](int index){
+        int forward = wrap(index - m_currentIndex);
+        return forward <= m_lookahead ? forward : n + (n - forward);
+    };
+
+    std::sort(order.begin(), order.end(), [=](int a, int b){
+        return rank(a) > rank(b);
+    });
+
+    qint64 released = 0;
+    for (auto index : order)
+    {
+        if (released >= bytes)
+            break;
+
+        QImage image = m_window.take(index);
+        if (!isShared(image))
+            released += image.sizeInBytes();
+    }
+
+    return released;
+}
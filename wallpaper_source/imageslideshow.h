@@ -0,0 +1,118 @@
+#ifndef IMAGESLIDESHOW_H
+#define IMAGESLIDESHOW_H
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include "imagedecoder.h"
+#include "memorybudget.h"
+#include "playlist.h"
+
+// 多图片轮播数据源：只保留当前图片及其前后窗口内的图片，其余在后台线程中按需解码；动画和视频条目只识别类型
+class ImageSlideshow : public QObject, public MemoryConsumer
+{
+    Q_OBJECT
+
+public:
+    struct Statistics
+    {
+        int switches;                           // 切换到新条目的次数
+        double averageMs;                       // 每次切换在界面线程上的耗时，含解码结果交接和壁纸窗口的更新
+        double maxMs;
+    };
+
+    explicit ImageSlideshow(QObject *parent = nullptr);
+    ~ImageSlideshow();
+
+    void setFiles(const QStringList &files);
+    void setPlaylist(const Playlist *playlist);
+    bool isGrouped() const;
+    int count() const;
+    int duration(int index) const;
+
+    // 文件夹轮播的条目随目录变化增删，播放列表轮播不使用
+    void addFiles(const QStringList &files);
+    void removeFiles(const QStringList &files);
+    void renameFile(const QString &oldPath, const QString &newPath);
+
+    void setTargetSize(const QSize &size, qreal devicePixelRatio = 1.0);
+
+    void setWindow(int lookbehind, int lookahead);
+    void setPrefetchEnabled(bool enabled);
+    bool isPrefetchEnabled() const;
+    int lookbehind() const;
+    int lookahead() const;
+
+    int currentIndex() const;
+    int decodeEstimate() const;
+    Statistics statistics() const;
+    QImage currentImage() const;
+    QStringList currentFiles() const;
+
+    bool start();
+    bool next();
+    bool show(int index);
+    void prefetchIndex(int index);
+    void clear();
+
+    QString memoryName() const override;
+    qint64 memoryUsage() const override;
+    int memoryPriority() const override;
+    qint64 releaseMemory(qint64 bytes) override;
+
+signals:
+    void currentChanged(const QImage &image);
+    void mediaChanged(const QString &file, MediaRegistry::Kind kind);
+
+private slots:
+    void onDecoded(int id, const QString &path, const QImage &image, MediaRegistry::Kind kind);
+    void groupPlaylist();
+
+private:
+    QString entry(int index) const;
+    int wrap(int index) const;
+    QHash<int, QImage> remapWindow(const QVector<int> &map) const;
+    bool inWindow(int index) const;
+    bool isWanted(int index) const;
+    bool isShared(const QImage &image) const;
+    QStringList groupVariants(const QStringList &files);
+    bool addVariant(const QString &file);
+    bool removeVariant(const QString &path);
+    void request(int index, ImageDecoder::Priority priority);
+    bool showTarget();
+    void recordSwitch(qint64 nsecs);
+    void trimWindow();
+    void prefetch();
+    qint64 estimatedBytes() const;
+
+private:
+    ImageDecoder *m_pDecoder = new ImageDecoder(this);
+    const Playlist *m_pPlaylist = nullptr;      // 不为空时条目直接按下标从播放列表读取，m_files 不使用
+    QStringList m_files;                        // 每组分辨率版本只占一个条目，以最先出现的文件代表
+    QSet<int> m_merged;                         // 播放列表中并入其他条目分组的下标
+    int m_grouped = 0;                          // 播放列表中已完成分组的条目数
+    QTimer m_groupTimer;
+    QHash<QString, QString> m_representatives;  // 分组键 -> 代表条目
+    QHash<QString, QStringList> m_variants;     // 代表条目 -> 同组全部文件，只有一种分辨率时不记录
+    QHash<int, QImage> m_window;               // 已解码的图片，解码失败记为空图
+    QHash<QString, MediaRegistry::Kind> m_media;  // 动画和视频条目，窗口中记为空图，显示时交给界面按各自的方式播放
+    QHash<int, int> m_pending;                  // 图片索引 -> 解码请求
+    QHash<int, int> m_requests;                 // 解码请求 -> 图片索引
+    int m_currentIndex = 0;
+    int m_targetIndex = -1;                     // 等待解码完成后显示的图片
+    int m_upcomingIndex = -1;                   // 调度器通知即将显示的图片，不在前后窗口内时同样保留
+    int m_failures = 0;
+    int m_lookbehind = 1;
+    int m_lookahead = 2;
+    bool m_prefetchEnabled = true;              // 壁纸不可见时关闭后台预取
+    int m_switches = 0;
+    qint64 m_switchTotal = 0;                   // 纳秒
+    qint64 m_switchMax = 0;
+};
+
+#endif // IMAGESLIDESHOW_H
@@ -0,0 +1,88 @@
+#include "jitterhistogram.h"
+
+#include <QJsonArray>
+
+void JitterHistogram::add(qint64 usec)
+{
+    usec = qMax<qint64>(0, usec);
+
+    int index = 0;
+    while (index < BucketCount - 1 && usec >= bucketLimit(index))
+        ++index;
+
+    m_buckets[index]++;
+    m_count++;
+    m_sum += usec;
+    m_max = qMax(m_max, usec);
+}
+
+void JitterHistogram::clear()
+{
+    *this = JitterHistogram();
+}
+
+int JitterHistogram::count() const
+{
+    return m_count;
+}
+
+int JitterHistogram::bucket(int index) const
+{
+    return index >= 0 && index < BucketCount ? m_buckets[index] : 0;
+}
+
+qint64 JitterHistogram::bucketLimit(int index)
+{
+    return index < BucketCount - 1 ? qint64(1000) << index : -1;
+}
+
+double JitterHistogram::mean() const
+{
+    return m_count > 0 ? m_sum / 1e3 / m_count : 0.0;
+}
+
+double JitterHistogram::maximum() const
+{
+    return m_max / 1e3;
+}
+
+double JitterHistogram::percentile(double fraction) const
+{
+    if (m_count == 0)
+        return 0.0;
+
+    // 最后一桶没有上限，以最大值代替
+    const double target = fraction * m_count;
+    int seen = 0;
+    for (int i = 0; i < BucketCount - 1; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+            return qMin(bucketLimit(i), m_max) / 1e3;
+    }
+
+    return maximum();
+}
+
+QJsonObject JitterHistogram::toJson() const
+{
+    QJsonArray buckets;
+    for (int i = 0; i < BucketCount; ++i)
+    {
+        QJsonObject bucket;
+        bucket.insert("belowMs", i < BucketCount - 1 ? QJsonValue(bucketLimit(i) / 1e3) : QJsonValue());
+        bucket.insert("frames", m_buckets[i]);
+        buckets.append(bucket);
+    }
+
+    QJsonObject result;
+    result.insert("frames", m_count);
+    result.insert("meanMs", mean());
+    result.insert("p50Ms", percentile(0.5));
+    result.insert("p95Ms", percentile(0.95));
+    result.insert("p99Ms", percentile(0.99));
+    result.insert("maxMs", maximum());
+    result.insert("buckets", buckets);
+
+    return result;
+}
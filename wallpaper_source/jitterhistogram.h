@@ -0,0 +1,32 @@
+#ifndef JITTERHISTOGRAM_H
+#define JITTERHISTOGRAM_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+
+// 帧显示抖动统计：实际显示时刻晚于计划时刻的时长，按 2 的幂毫秒分桶，可导出为 JSON 对比不同构建
+class JitterHistogram
+{
+public:
+    static const int BucketCount = 10;          // 小于 1、2、4 …… 256 毫秒，最后一桶为 256 毫秒以上
+
+    void add(qint64 usec);
+    void clear();
+
+    int count() const;
+    int bucket(int index) const;
+    static qint64 bucketLimit(int index);       // 桶的上限，微秒，最后一桶为 -1
+    double mean() const;                        // 毫秒
+    double maximum() const;                     // 毫秒
+    double percentile(double fraction) const;   // 所在桶的上限，毫秒
+
+    QJsonObject toJson() const;
+
+private:
+    int m_buckets[BucketCount] = { };
+    int m_count = 0;
+    qint64 m_sum = 0;                           // 微秒
+    qint64 m_max = 0;
+};
+
+#endif // JITTERHISTOGRAM_H
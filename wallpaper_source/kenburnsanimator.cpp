@@ -0,0 +1,276 @@
+#include "kenburnsanimator.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <random>
+
+#include "imagedecoder.h"
+#include "memorybudget.h"
+#include "pixelkernels.h"
+#include "resolutionvariants.h"
+
+namespace
+{
+struct Band
+{
+    int begin;
+    int end;
+};
+}
+
+KenBurnsAnimator::KenBurnsAnimator(QObject *parent) : QObject(parent)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+
+    connect(&m_timer, &QTimer::timeout, this, &KenBurnsAnimator::onTick);
+}
+
+KenBurnsAnimator::~KenBurnsAnimator()
+{
+    stop();
+}
+
+void KenBurnsAnimator::setFrameRate(int fps)
+{
+    m_frameRate = qBound(1, fps, 120);
+
+    if (m_timer.isActive())
+        m_timer.setInterval(1000 / m_frameRate);
+}
+
+int KenBurnsAnimator::frameRate() const
+{
+    return m_frameRate;
+}
+
+void KenBurnsAnimator::setMaxZoom(qreal zoom)
+{
+    m_maxZoom = qBound<qreal>(1.0, zoom, 2.0);
+}
+
+qreal KenBurnsAnimator::maxZoom() const
+{
+    return m_maxZoom;
+}
+
+bool KenBurnsAnimator::isRunning() const
+{
+    return m_timer.isActive();
+}
+
+bool KenBurnsAnimator::isPaused() const
+{
+    return m_paused;
+}
+
+KenBurnsAnimator::Statistics KenBurnsAnimator::statistics() const
+{
+    return m_statistics;
+}
+
+void KenBurnsAnimator::start(const QImage &image, int duration, quint32 seed, const QStringList &files)
+{
+    stop();
+
+    if (image.isNull())
+        return;
+
+    const QImage::Format format = image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+
+    m_duration = qMax(1, duration);
+
+    // 从完整画面开始，与切换特效的最后一帧衔接；逐渐放大到随机选取的一块区域
+    std::mt19937 engine(seed);
+    const qreal w = image.width();
+    const qreal h = image.height();
+    const qreal zoom = 1.0 + (m_maxZoom - 1.0) * (0.5 + (engine() % 1000) / 2000.0);
+    const QSizeF size(w / zoom, h / zoom);
+    const QPointF origin((w - size.width()) * (engine() % 1001) / 1000.0, (h - size.height()) * (engine() % 1001) / 1000.0);
+
+    m_from = QRectF(0, 0, w, h);
+    m_to   = QRectF(origin, size);
+
+    for (auto &frame : m_frames)
+    {
+        if (frame.size() != image.size() || frame.format() != format)
+            frame = QImage(image.size(), format);
+        frame.setDevicePixelRatio(image.devicePixelRatio());
+    }
+
+    // 高分辨率画面要先在预算中申请到内存，预算不足时直接用屏幕尺寸的原图取景
+    qint64 bytes = 0;
+    for (auto &frame : m_frames)
+        bytes += frame.sizeInBytes();
+    MemoryBudget::instance()->setReserved(QStringLiteral("kenburns"), bytes + image.sizeInBytes());
+
+    const qint64 sourceBytes = qint64(image.sizeInBytes() * m_maxZoom * m_maxZoom);
+    const qreal decodeZoom = MemoryBudget::instance()->reserve(sourceBytes - image.sizeInBytes()) ? m_maxZoom : 1.0;
+    if (decodeZoom > 1.0)
+        MemoryBudget::instance()->setReserved(QStringLiteral("kenburns"), bytes + sourceBytes);
+
+    // 高分辨率画面在工作线程中解码，解码期间保持显示原图
+    m_hasPending = false;
+    m_finished   = false;
+    m_render = QtConcurrent::run([=](){
+        loadSource(image.format() == format ? image : image.convertToFormat(format), files, decodeZoom);
+    });
+
+    m_elapsed = 0;
+    m_paused  = false;
+    m_clock.start();
+    m_timer.start(1000 / m_frameRate);
+}
+
+void KenBurnsAnimator::stop()
+{
+    m_timer.stop();
+    m_render.waitForFinished();
+    m_hasPending = false;
+    m_paused = false;
+    m_duration = 0;
+    m_source = QImage();
+
+    MemoryBudget::instance()->setReserved(QStringLiteral("kenburns"), 0);
+}
+
+void KenBurnsAnimator::pause()
+{
+    // 只读界面线程的状态，工作线程可能仍在解码取景画面
+    if (m_paused || m_duration == 0)
+        return;
+
+    // 保留取景画面和已播放的时长，恢复时从暂停的画面继续
+    m_paused  = true;
+    m_elapsed += m_clock.elapsed();
+    m_timer.stop();
+}
+
+void KenBurnsAnimator::resume()
+{
+    if (!m_paused)
+        return;
+
+    m_paused = false;
+    m_clock.start();
+
+    if (!m_finished || m_hasPending)
+        m_timer.start(1000 / m_frameRate);
+}
+
+void KenBurnsAnimator::onTick()
+{
+    // 上一帧尚未完成时本帧丢弃，帧率上限之外不额外占用处理器
+    if (!m_render.isFinished())
+    {
+        m_statistics.framesDropped++;
+        return;
+    }
+
+    if (m_hasPending)
+    {
+        const int front = m_backIndex;
+        m_backIndex = 1 - m_backIndex;
+        m_statistics.framesPresented++;
+        emit frameReady(m_frames[front]);
+    }
+
+    // 最后一帧呈现后停在该画面
+    if (m_finished)
+    {
+        m_timer.stop();
+        return;
+    }
+
+    const qreal progress = qMin<qreal>(1.0, qreal(m_elapsed + m_clock.elapsed() + m_timer.interval()) / m_duration);
+    render(viewport(progress));
+    m_finished = progress >= 1.0;
+}
+
+void KenBurnsAnimator::loadSource(const QImage &image, const QStringList &files, qreal zoom)
+{
+    // 放大到终点时取景框为屏幕的 1 / zoom，按 zoom 倍屏幕尺寸解码正好一比一采样；不写入磁盘缓存
+    const QSize size = (QSizeF(image.size()) * zoom).toSize();
+    QImage source;
+
+    if (!files.isEmpty() && size != image.size())
+    {
+        const QString file = files.count() > 1 ? ResolutionVariants::select(files, size) : files.first();
+        source = ImageDecoder::decodeFile(file, size, image.devicePixelRatio(), false);
+    }
+
+    if (source.isNull())
+        m_source = image;
+    else
+        m_source = source.format() == image.format() ? source : source.convertToFormat(image.format());
+}
+
+QRectF KenBurnsAnimator::viewport(qreal progress) const
+{
+    // 匀速运动，缓慢的平移缩放不需要缓动
+    return QRectF(m_from.x() + (m_to.x() - m_from.x()) * progress,
+                  m_from.y() + (m_to.y() - m_from.y()) * progress,
+                  m_from.width() + (m_to.width() - m_from.width()) * progress,
+                  m_from.height() + (m_to.height() - m_from.height()) * progress);
+}
+
+void KenBurnsAnimator::render(const QRectF &viewport)
+{
+    // 在界面线程中取得可写指针，界面仍持有上一轮的帧时在这里分离
+    uchar *out = m_frames[m_backIndex].bits();
+    const int threads = qMax(1, QThread::idealThreadCount() - 1);
+    const int rows = m_frames[m_backIndex].height();
+
+    m_hasPending = true;
+    m_render = QtConcurrent::run([=](){
+        QVector<Band> bands;
+        for (int i = 0; i < threads; ++i)
+            bands.append({ rows * i / threads, rows * (i + 1) / threads });
+
+        QtConcurrent::blockingMap(bands, [=](const Band &band){
+            renderBand(out, viewport, band.begin, band.end);
+        });
+    });
+}
+
+void KenBurnsAnimator::renderBand(uchar *out, const QRectF &viewport, int begin, int end) const
+{
+    const int width  = m_frames[0].width();
+    const int height = m_frames[0].height();
+    const int stride = m_frames[0].bytesPerLine();
+
+    // 取景画面最多是屏幕的 maxZoom 倍，缩小不超过 2 倍，双线性即可
+    const QImage &source = m_source;
+    const qreal factorX = qreal(source.width()) / width;
+    const qreal factorY = qreal(source.height()) / height;
+
+    // 像素中心对齐，坐标为 16.16 定点数；右侧和下方各留一个像素给插值
+    const qreal sx = viewport.width() * factorX / width;
+    const qreal sy = viewport.height() * factorY / height;
+    const qreal x0 = qBound<qreal>(0, viewport.x() * factorX + 0.5 * sx - 0.5, source.width() - 1);
+    const quint32 dx = quint32(sx * 65536);
+    const quint32 fx = quint32(x0 * 65536);
+
+    QVector<quint32> row(source.width() + 1);
+
+    for (int y = begin; y < end; ++y)
+    {
+        const qreal fy = qBound<qreal>(0, viewport.y() * factorY + (y + 0.5) * sy - 0.5, source.height() - 1);
+        const int y0 = int(fy);
+        const int y1 = qMin(y0 + 1, source.height() - 1);
+        const int weight = int((fy - y0) * 256);
+
+        // 先把相邻两行按垂直权重混合成一行，再沿水平方向插值
+        const int first = int(fx >> 16);
+        const int last  = qMin(int((fx + dx * quint32(width - 1)) >> 16) + 1, source.width() - 1);
+        const int span  = last - first + 1;
+
+        PixelKernels::blend(reinterpret_cast<const quint32*>(source.constScanLine(y0)) + first,
+                            reinterpret_cast<const quint32*>(source.constScanLine(y1)) + first,
+                            row.data(), span, weight);
+        row[span] = row[span - 1];
+
+        PixelKernels::sampleLinear(row.data(), reinterpret_cast<quint32*>(out + y * stride), width,
+                                   fx - (quint32(first) << 16), dx);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef KENBURNSANIMATOR_H
+#define KENBURNSANIMATOR_H
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QImage>
+#include <QObject>
+#include <QRectF>
+#include <QStringList>
+#include <QTimer>
+
+// 静态图片的缓慢平移缩放动画：每张图片按最大放大倍数重新解码出更高分辨率的画面，每帧只做一次双线性采样
+// 取景框最小时正好一比一采样，最大时缩小不超过最大放大倍数，放大过程中画面不会变模糊
+class KenBurnsAnimator : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Statistics
+    {
+        int framesPresented;
+        int framesDropped;
+    };
+
+    explicit KenBurnsAnimator(QObject *parent = nullptr);
+    ~KenBurnsAnimator();
+
+    void setFrameRate(int fps);
+    int frameRate() const;
+
+    void setMaxZoom(qreal zoom);
+    qreal maxZoom() const;
+
+    bool isRunning() const;
+    bool isPaused() const;
+    Statistics statistics() const;
+
+    void start(const QImage &image, int duration, quint32 seed, const QStringList &files = QStringList());
+    void stop();
+    void pause();
+    void resume();
+
+signals:
+    void frameReady(const QImage &frame);
+
+private slots:
+    void onTick();
+
+private:
+    void loadSource(const QImage &image, const QStringList &files, qreal zoom);
+    QRectF viewport(qreal progress) const;
+    void render(const QRectF &viewport);
+    void renderBand(uchar *out, const QRectF &viewport, int begin, int end) const;
+
+private:
+    int m_frameRate = 30;
+    qreal m_maxZoom = 1.2;
+
+    QImage m_source;                            // 取景用的画面，解码失败时即屏幕尺寸的原图
+    QRectF m_from;                              // 起止取景框，屏幕尺寸原图的像素坐标
+    QRectF m_to;
+    int m_duration = 0;
+
+    QImage m_frames[2];
+    int m_backIndex = 0;
+    QFuture<void> m_render;
+    bool m_hasPending = false;
+    bool m_finished = false;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_elapsed = 0;                       // 暂停之前已经播放的时长
+    bool m_paused = false;
+
+    Statistics m_statistics = { 0, 0 };
+};
+
+#endif // KENBURNSANIMATOR_H
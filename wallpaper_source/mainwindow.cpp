@@ -2,9 +2,12 @@
 
 #include <QApplication>
 #include <QColorDialog>
+#include <QDateTime>
 #include <QDesktopServices>
 #include <QEvent>
+#include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QFont>
 #include <QFontDatabase>
 #include <QFontDialog>
@@ -13,11 +16,15 @@
 #include <QGridLayout>
 #include <QHBoxLayout>
 #include <QIcon>
+#include <QImageReader>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QLabel>
 #include <QMenu>
 #include <QMessageBox>
-#include <QMovie>
 #include <QPlainTextEdit>
+#include <QRandomGenerator>
+#include <QScreen>
 #include <QSettings>
 #include <QStringLiteral>
 #include <qt_windows.h>
@@ -30,6 +37,10 @@
 #include <VLCQtCore/Audio.h>
 
 #include "characterlabel.h"
+#include "mediaregistry.h"
+#include "memorybudget.h"
+#include "wallpapercache.h"
+#include "wallpapersurface.h"
 
 void Sleep(int msec)
 {
@@ -46,12 +57,16 @@ MainWindow::MainWindow(QWidget *parent)
     initConctol();
     createDefaultWallpaper(qApp->applicationDirPath() + "/default.png");
     restoreState();
+    applyPowerProfile();
     loadResourcesFile();
     m_pTrayIcon->showMessage(QString("简单桌面"), QStringLiteral("👧 我开始接管你的桌面啦"));
 }
 
 MainWindow::~MainWindow()
 {
+    // 退出前写回尚未保存的内容哈希索引，下次启动直接查询磁盘缓存
+    WallpaperCache::instance()->saveHashes();
+
     m_pTaskbarControl->setAccentState(TaskbarControl::ACCENT_ENABLE_GRADIENT);
     m_pTaskbarControl->setColor(QColor(255, 255, 255));
     m_pTaskbarControl->setAutoHide(false);
@@ -64,11 +79,13 @@ void MainWindow::initUi()
     QHBoxLayout *pResSettingLayout = new QHBoxLayout;
     m_pResourcesFileRadioBtn       = new QRadioButton(QStringLiteral("单静态图片&&GIF&&视频文件"));
     m_pResourcesFilesRadioBtn      = new QRadioButton(QStringLiteral("多静态图片"));
+    m_pResourcesFolderRadioBtn     = new QRadioButton(QStringLiteral("文件夹"));
     m_pSelectResourcesBtn          = new QPushButton(QStringLiteral("选择背景文件"));
 
     m_pResourcesFilesRadioBtn->setChecked(true);
     pResSettingLayout->addWidget(m_pResourcesFilesRadioBtn);
     pResSettingLayout->addWidget(m_pResourcesFileRadioBtn);
+    pResSettingLayout->addWidget(m_pResourcesFolderRadioBtn);
     pResSettingLayout->addStretch();
     pResSettingLayout->addWidget(m_pSelectResourcesBtn);
     pResSettingLayout->setSpacing(15);
@@ -76,14 +93,24 @@ void MainWindow::initUi()
 
     // 特效设置
     QGroupBox *pEffectSettingBox      = new QGroupBox(QStringLiteral("特效设置"), this);
-    QHBoxLayout *pEffectSettingLayout = new QHBoxLayout;
+    QVBoxLayout *pEffectSettingLayout = new QVBoxLayout;
+    QHBoxLayout *pEffectSettingSubLayout1 = new QHBoxLayout;
+    QHBoxLayout *pEffectSettingSubLayout2 = new QHBoxLayout;
     m_pTimeIntervalSpinBox            = new QSpinBox;
+    m_pTransitionBox                  = new QComboBox;
+    m_pShuffleBox                     = new QCheckBox(QStringLiteral("随机"));
+    m_pKenBurnsBox                    = new QCheckBox(QStringLiteral("平移缩放"));
     m_pVolumeSlider                   = new QSlider;
 
     m_pTimeIntervalSpinBox->setSuffix(QStringLiteral("秒"));
     m_pTimeIntervalSpinBox->setRange(1, 1000);
     m_pTimeIntervalSpinBox->setSingleStep(2);
     m_pTimeIntervalSpinBox->setValue(5);
+    m_pTransitionBox->addItem(QStringLiteral("无"), TransitionEngine::NoEffect);
+    m_pTransitionBox->addItem(QStringLiteral("淡入淡出"), TransitionEngine::CrossFade);
+    m_pTransitionBox->addItem(QStringLiteral("滑动"), TransitionEngine::Slide);
+    m_pTransitionBox->addItem(QStringLiteral("擦除"), TransitionEngine::Wipe);
+    m_pTransitionBox->setCurrentIndex(1);
     m_pVolumeSlider->setOrientation(Qt::Horizontal);
     m_pVolumeSlider->setStyleSheet("QSlider::groove{border: 1px solid #999999;background: #ffffff;}"
                                "QSlider::handle {border: 1px solid #999999;background: #88bbff;}"
@@ -92,11 +119,20 @@ void MainWindow::initUi()
                                "QSlider::add-page{border: 1px solid #999999;background:#eeeeef;}"
                                "QSlider::sub-page{background: #eeaa22;}");
 
-    pEffectSettingLayout->addWidget(new QLabel(QStringLiteral("多图片切换间隔")));
-    pEffectSettingLayout->addWidget(m_pTimeIntervalSpinBox);
-    pEffectSettingLayout->addSpacing(20);
-    pEffectSettingLayout->addWidget(new QLabel(QStringLiteral("视频音量大小")));
-    pEffectSettingLayout->addWidget(m_pVolumeSlider);
+    pEffectSettingSubLayout1->addWidget(new QLabel(QStringLiteral("多图片切换间隔")));
+    pEffectSettingSubLayout1->addWidget(m_pTimeIntervalSpinBox);
+    pEffectSettingSubLayout1->addSpacing(20);
+    pEffectSettingSubLayout1->addWidget(new QLabel(QStringLiteral("视频音量大小")));
+    pEffectSettingSubLayout1->addWidget(m_pVolumeSlider);
+
+    pEffectSettingSubLayout2->addWidget(new QLabel(QStringLiteral("切换效果")));
+    pEffectSettingSubLayout2->addWidget(m_pTransitionBox);
+    pEffectSettingSubLayout2->addWidget(m_pShuffleBox);
+    pEffectSettingSubLayout2->addWidget(m_pKenBurnsBox);
+    pEffectSettingSubLayout2->addStretch();
+
+    pEffectSettingLayout->addLayout(pEffectSettingSubLayout1);
+    pEffectSettingLayout->addLayout(pEffectSettingSubLayout2);
     pEffectSettingBox->setLayout(pEffectSettingLayout);
 
     // 文字设置
@@ -188,11 +224,19 @@ void MainWindow::initUi()
     QHBoxLayout *pAppSettingLayout = new QHBoxLayout;
     QLabel *pUrlLbl                = new QLabel();
     m_pAutoRuningCheckBox          = new QCheckBox(QStringLiteral("开机自启动"));
+    m_pPowerModeBox                = new QComboBox;
 
     pUrlLbl->setOpenExternalLinks(true);
     pUrlLbl->setText(QStringLiteral("<a href=\"%1\">访问作者网站").arg(AuthorUrl));
+    m_pPowerModeBox->addItem(QStringLiteral("自动"), PowerProfile::Automatic);
+    m_pPowerModeBox->addItem(QStringLiteral("性能"), PowerProfile::Performance);
+    m_pPowerModeBox->addItem(QStringLiteral("均衡"), PowerProfile::Balanced);
+    m_pPowerModeBox->addItem(QStringLiteral("节能"), PowerProfile::Battery);
 
     pAppSettingLayout->addWidget(m_pAutoRuningCheckBox);
+    pAppSettingLayout->addSpacing(20);
+    pAppSettingLayout->addWidget(new QLabel(QStringLiteral("电源模式")));
+    pAppSettingLayout->addWidget(m_pPowerModeBox);
     pAppSettingLayout->addStretch();
     pAppSettingLayout->addWidget(pUrlLbl);
     pAppSettingBox->setLayout(pAppSettingLayout);
@@ -208,7 +252,7 @@ void MainWindow::initUi()
 
     setWindowIcon(QIcon(":/image/image/logo.ico"));
     setWindowTitle(QStringLiteral("简单桌面 - 设置"));
-    setFixedSize(500, 450);
+    setFixedSize(500, 490);
 }
 
 void MainWindow::initSystemTray()
@@ -279,6 +323,43 @@ void MainWindow::initConctol()
     connect(m_pCharacteYBox, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &MainWindow::onCharacteLblMove);
     connect(m_pCharacteSlider, &QSlider::valueChanged, this, &MainWindow::SetCharacteLbOpacity);
 
+    connect(m_pTimeIntervalSpinBox, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), [=](int val){
+        m_pScheduler->setDefaultDuration(val * 1000);
+    });
+
+    connect(m_pShuffleBox, &QCheckBox::toggled, [=](bool checked){
+        m_pScheduler->setShuffle(checked, m_shuffleSeed);
+    });
+
+    connect(m_pKenBurnsBox, &QCheckBox::toggled, [=](bool checked){
+        if (!checked)
+            m_pKenBurns->stop();
+        else if (m_pSurface != nullptr && !m_pSlideshow->currentImage().isNull() && !m_pTransition->isRunning())
+            startKenBurns(m_pSlideshow->currentImage());
+    });
+
+    connect(m_pKenBurns, &KenBurnsAnimator::frameReady, this, [=](const QImage &frame){
+        if (m_pSurface != nullptr)
+            m_pSurface->setImage(frame);
+    });
+
+    connect(m_pTransitionBox, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [=](int index){
+        m_pTransition->setEffect(TransitionEngine::Effect(m_pTransitionBox->itemData(index).toInt()));
+    });
+
+    connect(m_pTransition, &TransitionEngine::frameReady, this, [=](const QImage &frame){
+        if (m_pSurface != nullptr)
+            m_pSurface->setImage(frame);
+    });
+
+    connect(m_pTransition, &TransitionEngine::finished, this, [=](const QImage &to){
+        if (m_pSurface != nullptr)
+        {
+            m_pSurface->setImage(to);
+            startKenBurns(to);
+        }
+    });
+
     connect(m_pVolumeSlider, &QSlider::valueChanged, [=](int val){
         if (m_pVedioLbl != nullptr)
             m_pPlayer->audio()->setVolume(val);
@@ -321,44 +402,114 @@ void MainWindow::initConctol()
             this->show();
     });
 
+    // 切换过程中旧视频播放结束不重新加载；轮播中的视频从头播放，直到本条目的显示时间结束
     connect(m_pPlayer, &VlcMediaPlayer::end, this, [=](){
-        loadResourcesFile();
+        if (m_switching)
+            return;
+
+        if (m_pSlideshow->count() > 0)
+            m_pPlayer->play();
+        else
+            loadResourcesFile();
+    });
+
+    connect(m_pPlayer, &VlcMediaPlayer::vout, this, [=](int count){
+        if (count <= 0 || m_pVedioLbl == nullptr)
+            return;
+
+        if (m_switching)
+        {
+            finishSwitch();
+        }
+        else
+        {
+            m_pVedioLbl->show();
+            m_pCharacterLbl->hide();
+        }
+    });
+
+    connect(m_pSlideshow, &ImageSlideshow::currentChanged, this, &MainWindow::onSlideshowCurrentChanged);
+    connect(m_pSlideshow, &ImageSlideshow::mediaChanged, this, &MainWindow::onSlideshowMediaChanged);
+
+    // 播放列表中单独指定的显示时长在预取时读取，调度器在随后切换到该条目时用它计算下一次截止时间
+    connect(m_pScheduler, &SlideshowScheduler::prefetch, this, [=](int index){
+        m_pScheduler->setDuration(index, m_pSlideshow->duration(index));
+    });
+    connect(m_pScheduler, &SlideshowScheduler::prefetch, m_pSlideshow, &ImageSlideshow::prefetchIndex);
+    connect(m_pScheduler, &SlideshowScheduler::advance, m_pSlideshow, &ImageSlideshow::show);
+
+    connect(m_pFolderIndexer, &FolderIndexer::filesAdded, this, [=](const QStringList &files){
+        bool first = m_pSlideshow->count() == 0;
+        m_pSlideshow->addFiles(files);
+        m_pScheduler->setCount(m_pSlideshow->count());
+        if (first)
+            m_pSlideshow->start();
+    });
+    connect(m_pFolderIndexer, &FolderIndexer::filesRemoved, this, [=](const QStringList &files){
+        m_pSlideshow->removeFiles(files);
+        m_pScheduler->setCount(m_pSlideshow->count());
+        m_pScheduler->setCurrent(m_pSlideshow->currentIndex());
+    });
+    connect(m_pFolderIndexer, &FolderIndexer::fileRenamed, m_pSlideshow, &ImageSlideshow::renameFile);
+
+    connect(m_pPowerModeBox, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [=](int index){
+        m_pPowerProfile->setMode(m_pPowerModeBox->itemData(index).toInt());
     });
+
+    connect(m_pPowerProfile, &PowerProfile::profileChanged, this, &MainWindow::applyPowerProfile);
+
+    // 任务栏在桌面被遮挡时仍然可见，只在锁屏时停止刷新
+    connect(m_pVisibility, &VisibilityMonitor::visibilityChanged, this, &MainWindow::onVisibilityChanged);
+    connect(m_pVisibility, &VisibilityMonitor::stateChanged, this, [=](VisibilityBackend::State state){
+        m_pTaskbarControl->setSuspended(state == VisibilityBackend::Locked);
+    });
+    connect(QGuiApplication::primaryScreen(), &QScreen::geometryChanged, this, &MainWindow::updateWallpaperSize);
 }
 
 bool MainWindow::loadResourcesFile()
 {
-    if (m_filesPath.count() <= 0 && m_pMovieLbl == nullptr && m_pImageLbl == nullptr && m_pVedioLbl == nullptr)
+    if (m_playlist.isEmpty() && m_folderPath.isEmpty() && m_pSurface == nullptr)
         return false;
 
-    removeAllWallpaper();
-
-    if (m_filesPath.at(0).endsWith(QStringLiteral(".gif"), Qt::CaseInsensitive))
+    if (m_folderPath.isEmpty() && m_playlist.isEmpty())
     {
-        createMovieWallpaper(m_filesPath.at(0));
-
-        m_pCharacterLbl->setVisible(m_pCharacterVisibleBox->isChecked());
+        removeAllWallpaper();
+        return true;
     }
-    else if (m_filesPath.at(0).endsWith(QStringLiteral(".jpg"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".jpeg"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".jpe"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".jfif"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".png"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".ico"), Qt::CaseInsensitive))
-    {
-        createImageWallpaper(m_filesPath);
 
-        m_pCharacterLbl->setVisible(m_pCharacterVisibleBox->isChecked());
+    // 旧壁纸继续显示，新壁纸的第一帧就绪后在同一个壁纸窗口上替换
+    beginSwitch();
+
+    if (!m_folderPath.isEmpty())
+    {
+        createFolderWallpaper(m_folderPath);
+        return true;
     }
-    else if (m_filesPath.at(0).endsWith(QStringLiteral(".mp4"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".flv"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".rmvb"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".avi"), Qt::CaseInsensitive)
-          || m_filesPath.at(0).endsWith(QStringLiteral(".mkv"), Qt::CaseInsensitive))
+
+    // 多个文件时进入轮播，由轮播按条目逐个识别格式；单个文件按内容识别的类型分发
+    MediaRegistry::Kind kind = m_playlist.count() > 1 ? MediaRegistry::ImageKind
+                                                      : MediaRegistry::handlerForFile(m_playlist.at(0)).kind;
+
+    switch (kind)
     {
-        createVideoWallpaper(m_filesPath.at(0));
+    case MediaRegistry::ImageKind:
+        createImageWallpaper();
+        break;
+    case MediaRegistry::MovieKind:
+        createMovieWallpaper(m_playlist.at(0));
+        break;
+    case MediaRegistry::VideoKind:
+        createVideoWallpaper(m_playlist.at(0));
+        break;
+    default:
+        removeAllWallpaper();
+        return true;
     }
 
+    // 桌面不可见时创建的壁纸先停在第一帧
+    if (!m_pVisibility->isVisible())
+        suspendRendering(true);
+
     return true;
 }
 
@@ -385,91 +536,271 @@ HWND MainWindow::findDeskTopWindow()
 
 void MainWindow::removeAllWallpaper()
 {
-    if (m_pVedioLbl != nullptr)
+    if (m_pVedioLbl != nullptr || m_pPreviousVedioLbl != nullptr)
         m_pPlayer->stop();
 
-    delete m_pMovieLbl;
-    delete m_pImageLbl;
-    delete m_pVedioLbl;
+    m_pTransition->stop();
+    m_pKenBurns->stop();
+
+    // 动画和视频窗口都是壁纸窗口的子对象，随壁纸窗口一起释放
+    delete m_pSurface;
 
-    m_pMovieLbl = nullptr;
-    m_pImageLbl = nullptr;
-    m_pVedioLbl = nullptr;
+    m_pSurface   = nullptr;
+    m_pAnimation = nullptr;
+    m_pVedioLbl  = nullptr;
+    m_pPreviousAnimation = nullptr;
+    m_pPreviousVedioLbl  = nullptr;
+    m_switching  = false;
 
-    m_images.clear();
-    m_imageIndex = 0;
+    m_pScheduler->stop();
+    m_pSlideshow->clear();
+    m_pFolderIndexer->clear();
+
+    MemoryBudget::instance()->setReserved(QStringLiteral("video"), 0);
 }
 
-void MainWindow::createImageWallpaper(const QStringList &files)
+void MainWindow::beginSwitch()
 {
-    QPixmap pic;
-    for (auto item : files)
-        if (pic.load(item))
-            m_images.append(pic);
+    m_switchClock.start();
+
+    // 轮播数据源直接切换到新文件，旧图片保留在壁纸缓冲中继续显示
+    m_pScheduler->stop();
+    m_pSlideshow->clear();
+    m_pFolderIndexer->clear();
 
-    if (m_images.count() > 0)
+    // 上一次切换尚未完成时，未显示过的新壁纸直接丢弃，继续显示更早的那个
+    if (m_switching)
     {
-        m_pImageLbl = new QLabel();
+        if (m_pVedioLbl != nullptr)
+            m_pPlayer->stop();
 
-        m_pImageLbl->installEventFilter(this);
-        m_pImageLbl->setWindowFlag(Qt::FramelessWindowHint);
-        m_pImageLbl->setScaledContents(true);
-        m_pImageLbl->setPixmap(m_images.at(0));
-        m_pImageLbl->showFullScreen();
-        SetParent((HWND)m_pImageLbl->winId(), findDeskTopWindow());
-        m_pImageLbl->show();
+        delete m_pAnimation;
+        delete m_pVedioLbl;
+    }
+    else
+    {
+        m_pPreviousAnimation = m_pAnimation;
+        m_pPreviousVedioLbl  = m_pVedioLbl;
+    }
 
-        if (m_images.count() > 1)
-        {
-            QTimer *timer = new QTimer(m_pImageLbl);
-
-            connect(timer, &QTimer::timeout, [=](){
-                m_pImageLbl->setPixmap(m_images.at(m_imageIndex));
-                m_imageIndex = ++m_imageIndex % m_images.count();
-            });
-
-            connect(m_pTimeIntervalSpinBox, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), [=](int val){
-                if (timer!= nullptr)
-				{
-					timer->stop();
-					timer->start(val * 1000);
-				}
-            });
-
-            timer->start(m_pTimeIntervalSpinBox->value() * 1000);
-        }
+    m_pAnimation = nullptr;
+    m_pVedioLbl  = nullptr;
+    m_switching  = true;
+}
+
+void MainWindow::finishSwitch()
+{
+    if (!m_switching)
+        return;
+
+    m_switching = false;
+
+    // 旧壁纸的动画、视频和平移缩放到此为止
+    m_pKenBurns->stop();
+    m_pTransition->stop();
+
+    delete m_pPreviousAnimation;
+    m_pPreviousAnimation = nullptr;
+
+    if (m_pPreviousVedioLbl != nullptr)
+    {
+        if (m_pVedioLbl == nullptr)
+            m_pPlayer->stop();
+
+        delete m_pPreviousVedioLbl;
+        m_pPreviousVedioLbl = nullptr;
+    }
+
+    if (m_pVedioLbl != nullptr)
+        m_pVedioLbl->show();
+
+    if (m_pVedioLbl == nullptr)
+        MemoryBudget::instance()->setReserved(QStringLiteral("video"), 0);
+
+    // 壁纸窗口首次显示时由事件过滤器处理文字
+    if (m_pSurface != nullptr && m_pSurface->isVisible())
+        m_pCharacterLbl->setVisible(m_pCharacterVisibleBox->isChecked() && m_pVedioLbl == nullptr);
+
+    const qint64 latency = m_switchClock.elapsed();
+    m_switchCount++;
+    m_switchTotal += latency;
+    m_switchMax = qMax(m_switchMax, latency);
+}
+
+void MainWindow::abortSwitch(const QString &file)
+{
+    // 新壁纸一帧也无法显示时不停留在切换中，与无法识别的文件一样恢复系统壁纸并提示
+    removeAllWallpaper();
+    m_pTrayIcon->showMessage(QStringLiteral("简单桌面"), QStringLiteral("无法播放壁纸文件：%1").arg(QFileInfo(file).fileName()),
+                             QSystemTrayIcon::Warning);
+}
+
+void MainWindow::updateWallpaperSize()
+{
+    QScreen *screen = QGuiApplication::primaryScreen();
+    qreal ratio = screen->devicePixelRatio();
+
+    m_pSlideshow->setTargetSize(screen->size() * ratio, ratio);
+}
+
+void MainWindow::createImageWallpaper()
+{
+    // 轮播直接按下标读取播放列表，十万条的列表也不在启动时逐条解析
+    updateWallpaperSize();
+    m_pSlideshow->setPlaylist(&m_playlist);
+    m_pScheduler->setCount(m_pSlideshow->count());
+    m_pSlideshow->start();
+}
+
+void MainWindow::startKenBurns(const QImage &image)
+{
+    // 动画时长与本张图片的显示时长一致，每张图片的运动方向由随机种子和图片序号决定
+    if (!m_pKenBurnsBox->isChecked())
+        return;
+
+    m_pKenBurns->start(image, m_pScheduler->duration(m_pSlideshow->currentIndex()),
+                       m_shuffleSeed ^ quint32(m_pSlideshow->currentIndex()), m_pSlideshow->currentFiles());
+
+    if (!m_pVisibility->isVisible())
+        m_pKenBurns->pause();
+}
+
+void MainWindow::scheduleSlideshow()
+{
+    // 解码失败的条目会被跳过，以实际显示的条目为准；按最近的解码耗时调整预取提前量
+    const int index = m_pSlideshow->currentIndex();
+    m_pScheduler->setCurrent(index);
+    m_pScheduler->setDuration(index, m_pSlideshow->duration(index));
+    m_pScheduler->setDecodeEstimate(m_pSlideshow->decodeEstimate());
+
+    if (m_pScheduler->isActive())
+        return;
+
+    // 文件夹轮播中的文件会陆续增加，因此单张图片时同样启动调度
+    m_pScheduler->setDefaultDuration(m_pTimeIntervalSpinBox->value() * 1000);
+    m_pScheduler->start();
+
+    if (!m_pVisibility->isVisible())
+        m_pScheduler->pause();
+}
+
+void MainWindow::stopSlideMedia()
+{
+    // 轮播切换到下一条目时结束上一条目的动画或视频，动画的最后一帧留在壁纸缓冲中
+    if (m_pVedioLbl != nullptr)
+    {
+        m_pPlayer->stop();
+        delete m_pVedioLbl;
+        m_pVedioLbl = nullptr;
+
+        MemoryBudget::instance()->setReserved(QStringLiteral("video"), 0);
+
+        if (m_pSurface != nullptr && m_pSurface->isVisible())
+            m_pCharacterLbl->setVisible(m_pCharacterVisibleBox->isChecked());
     }
+
+    delete m_pAnimation;
+    m_pAnimation = nullptr;
+}
+
+void MainWindow::createFolderWallpaper(const QString &dir)
+{
+    // 目录在后台建立索引，第一批文件到达后开始轮播
+    updateWallpaperSize();
+    m_pSlideshow->setFiles(QStringList());
+    m_pScheduler->setCount(0);
+    m_pFolderIndexer->setDirectory(dir);
+}
+
+void MainWindow::createSurface()
+{
+    // 壁纸窗口只创建一次，之后的切换都在同一个窗口上完成
+    if (m_pSurface != nullptr)
+        return;
+
+    QScreen *screen = QGuiApplication::primaryScreen();
+
+    m_pSurface = new WallpaperSurface();
+    m_pSurface->installEventFilter(this);
+    m_pSurface->setWindowFlag(Qt::FramelessWindowHint);
+    m_pSurface->setBufferSize(screen->size() * screen->devicePixelRatio(), screen->devicePixelRatio());
+    m_pSurface->setUpdateRateLimit(m_pPowerProfile->limits().animationFps);
+
+    // 视频窗口铺满壁纸窗口
+    QVBoxLayout *layout = new QVBoxLayout(m_pSurface);
+    layout->setContentsMargins(0, 0, 0, 0);
+}
+
+void MainWindow::showSurface()
+{
+    if (m_pSurface->isVisible())
+        return;
+
+    m_pSurface->showFullScreen();
+    SetParent((HWND)m_pSurface->winId(), findDeskTopWindow());
+    m_pSurface->show();
 }
 
 void MainWindow::createMovieWallpaper(const QString &file)
 {
-   QMovie *movie = new QMovie(file);
-   m_pMovieLbl   = new QLabel();
+    createSurface();
+
+    // 第一轮播放时把每帧解码到壁纸缓冲尺寸，之后的循环只拷贝变化区域；第一帧整幅替换旧壁纸
+    AnimationPlayer *player = new AnimationPlayer(m_pSurface);
+    m_pAnimation = player;
+
+    auto present = [=](){
+        if (player == m_pAnimation && m_switching)
+            finishSwitch();
+    };
+    connect(player, &AnimationPlayer::patchReady, m_pSurface, [=](const QImage &patch, const QPoint &position){
+        present();
+        m_pSurface->blit(patch, position);
+    });
 
-   m_pMovieLbl->installEventFilter(this);
-   m_pMovieLbl->setWindowFlag(Qt::FramelessWindowHint);
-   m_pMovieLbl->setMovie(movie);
-   m_pMovieLbl->setScaledContents(true);
-   m_pMovieLbl->showFullScreen();
-   movie->setParent(m_pMovieLbl);
-   SetParent((HWND)m_pMovieLbl->winId(), findDeskTopWindow());
-   m_pMovieLbl->show();
-   movie->start();
+    // 排队处理，播放器随壁纸窗口释放时不在它自己发出的信号中；轮播中的动画无法播放时停在上一画面，到时间后照常切换
+    auto fail = [=](){
+        if (player != m_pAnimation)
+            return;
+
+        if (m_pSlideshow->count() > 0)
+            stopSlideMedia();
+        else if (m_switching)
+            abortSwitch(file);
+    };
+    connect(player, &AnimationPlayer::failed, this, fail, Qt::QueuedConnection);
+
+    showSurface();
+    if (!player->start(file, m_pSurface->bufferSize(), m_pSurface->buffer().devicePixelRatio()))
+        fail();
 }
 
 void MainWindow::createVideoWallpaper(const QString &file)
 {
-    m_pVedioLbl     = new VlcWidgetVideo();
-    VlcMedia *media = new VlcMedia(file, true, m_pInstance);
+    createSurface();
 
-    m_pVedioLbl->installEventFilter(this);
-    SetParent((HWND)m_pVedioLbl->winId(), findDeskTopWindow());
+    // 视频窗口作为壁纸窗口的子窗口铺满显示，视频输出建立前保持隐藏，旧壁纸继续显示
+    m_pVedioLbl         = new VlcWidgetVideo(m_pSurface);
+    VlcMedia *media     = new VlcMedia(file, true, m_pInstance);
+
+    m_pVedioLbl->hide();
+    m_pSurface->layout()->addWidget(m_pVedioLbl);
     media->setParent(media);
     media->setOption(":–directx-use-sysmem");
-    media->setOption(":avcodec-threads=0");
+    // 解码线程数和画质取舍在打开时确定，电源模式变化后从下一次打开生效
+    const PowerProfile::Limits limits = m_pPowerProfile->limits();
+    media->setOption(QStringLiteral(":avcodec-threads=%1").arg(limits.videoThreads));
     media->setOption(":avcodec-fast");
+    if (limits.videoSkipLoopFilter)
+        media->setOption(":avcodec-skiploopfilter=4");
+    if (limits.videoSkipIdct)
+        media->setOption(":avcodec-skip-idct=1");
     m_pPlayer->setVideoWidget(m_pVedioLbl);
-    m_pVedioLbl->showFullScreen();
+
+    // VLC 的图像缓冲池无法由程序回收，按三帧屏幕大小的 RGB32 估算登记
+    QSize screenSize = m_pSurface->bufferSize();
+    MemoryBudget::instance()->setReserved(QStringLiteral("video"), qint64(screenSize.width()) * screenSize.height() * 4 * 3);
+    showSurface();
     m_pPlayer->audio()->setVolume(m_pVolumeSlider->value());
     m_pPlayer->open(media);
 }
@@ -479,13 +810,57 @@ void MainWindow::createDefaultWallpaper(const QString &filePath)
     SystemParametersInfo(SPI_SETDESKWALLPAPER, 0,(void*)(filePath.toStdWString().c_str()), SPIF_SENDWININICHANGE |SPIF_UPDATEINIFILE);
 }
 
+void MainWindow::suspendRendering(bool suspended)
+{
+    // 暂停时保留当前画面和进度，恢复时无需重新加载
+    if (m_pAnimation != nullptr)
+        m_pAnimation->setPaused(suspended);
+
+    if (m_pVedioLbl != nullptr)
+    {
+        if (suspended)
+            m_pPlayer->pause();
+        else
+            m_pPlayer->resume();
+    }
+
+    if (suspended)
+    {
+        m_pScheduler->pause();
+        m_pKenBurns->pause();
+    }
+    else
+    {
+        m_pScheduler->resume();
+        m_pKenBurns->resume();
+    }
+
+    m_pSlideshow->setPrefetchEnabled(!suspended);
+}
+
+void MainWindow::applyPowerProfile()
+{
+    const PowerProfile::Limits limits = m_pPowerProfile->limits();
+
+    if (m_pSurface != nullptr)
+        m_pSurface->setUpdateRateLimit(limits.animationFps);
+
+    m_pTransition->setFrameRate(limits.transitionFps);
+    m_pKenBurns->setFrameRate(qMin(m_kenBurnsFps, limits.kenBurnsFps));
+    m_pSlideshow->setWindow(qMin(m_prefetchBehind, limits.lookbehind), qMin(m_prefetchAhead, limits.lookahead));
+}
+
 void MainWindow::saveState()
 {
     QSettings settings(QSettings::IniFormat, QSettings::UserScope, QCoreApplication::organizationName(), QCoreApplication::applicationName());
 
     settings.beginGroup("Ui");
     settings.setValue("resType", m_pResourcesFilesRadioBtn->isChecked());
+    settings.setValue("resFolder", m_pResourcesFolderRadioBtn->isChecked());
     settings.setValue("imageTime", m_pTimeIntervalSpinBox->value());
+    settings.setValue("transition", m_pTransitionBox->currentIndex());
+    settings.setValue("shuffle", m_pShuffleBox->isChecked());
+    settings.setValue("kenBurns", m_pKenBurnsBox->isChecked());
     settings.setValue("vedioVolume", m_pVolumeSlider->value());
     settings.setValue("characterVisible", m_pCharacterVisibleBox->isChecked());
     settings.setValue("characteText", m_pCharacteEdit->text());
@@ -497,10 +872,18 @@ void MainWindow::saveState()
     settings.setValue("taskBarBlurbehindBtn", m_pTaskBarBlurbehindBtn->isChecked());
     settings.setValue("taskBarAlphaSlider", m_pTaskBarAlphaSlider->value());
     settings.setValue("autoRuning", m_pAutoRuningCheckBox->isChecked());
+    settings.setValue("powerMode", m_pPowerModeBox->currentIndex());
     settings.endGroup();
 
     settings.beginGroup("Parameter");
-    settings.setValue("resFilePath", m_filesPath);
+    settings.setValue("resFolderPath", m_folderPath);
+    settings.setValue("shuffleSeed", m_shuffleSeed);
+    settings.setValue("kenBurnsFps", m_kenBurnsFps);
+    settings.setValue("prefetchBehind", m_prefetchBehind);
+    settings.setValue("prefetchAhead", m_prefetchAhead);
+    settings.setValue("prefetchLead", m_prefetchLead);
+    settings.setValue("diskCacheLimit", WallpaperCache::instance()->limit() / (1024 * 1024));
+    settings.setValue("memoryBudget", MemoryBudget::instance()->limit() / (1024 * 1024));
     settings.setValue("characteFont", m_pCharacterLbl->font());
     settings.setValue("characteColor", m_pCharacterLbl->color());
     settings.setValue("taskBarColor", m_pTaskbarControl->color());
@@ -511,12 +894,19 @@ void MainWindow::restoreState()
 {
     QSettings settings(QSettings::IniFormat, QSettings::UserScope, QCoreApplication::organizationName(), QCoreApplication::applicationName());
 
+    m_playlist.open(Playlist::defaultPath());
+
     if (settings.status() != QSettings::NoError)
         return;
 
     settings.beginGroup("Ui");
     settings.value("resType").toBool() ? m_pResourcesFilesRadioBtn->setChecked(true) : m_pResourcesFileRadioBtn->setChecked(true);
+    if (settings.value("resFolder").toBool())
+        m_pResourcesFolderRadioBtn->setChecked(true);
     m_pTimeIntervalSpinBox->setValue(settings.value("imageTime").toInt());
+    m_pTransitionBox->setCurrentIndex(settings.value("transition", 1).toInt());
+    m_pShuffleBox->setChecked(settings.value("shuffle").toBool());
+    m_pKenBurnsBox->setChecked(settings.value("kenBurns").toBool());
     m_pVolumeSlider->setValue(settings.value("vedioVolume").toInt());
     m_pCharacterVisibleBox->setChecked(settings.value("characterVisible").toBool());
     m_pCharacteEdit->setText(settings.value("characteText").toString());
@@ -528,10 +918,27 @@ void MainWindow::restoreState()
     m_pTaskBarBlurbehindBtn->setChecked(settings.value("taskBarBlurbehindBtn").toBool());
     m_pTaskBarAlphaSlider->setValue(settings.value("taskBarAlphaSlider").toInt());
     m_pAutoRuningCheckBox->setChecked(settings.value("autoRuning").toBool());
+    m_pPowerModeBox->setCurrentIndex(settings.value("powerMode").toInt());
     settings.endGroup();
 
     settings.beginGroup("Parameter");
-    m_filesPath = settings.value("resFilePath").toStringList();
+    // 旧版本把文件列表保存在配置文件中，迁移到播放列表文件后删除
+    if (settings.contains("resFilePath"))
+    {
+        m_playlist.setEntries(settings.value("resFilePath").toStringList());
+        settings.remove("resFilePath");
+    }
+    m_folderPath = settings.value("resFolderPath").toString();
+    // 随机种子只在首次运行时生成，之后每次启动的随机顺序保持一致
+    m_shuffleSeed = settings.contains("shuffleSeed") ? settings.value("shuffleSeed").toUInt() : QRandomGenerator::global()->generate();
+    m_pScheduler->setShuffle(m_pShuffleBox->isChecked(), m_shuffleSeed);
+    m_kenBurnsFps    = settings.value("kenBurnsFps", 30).toInt();
+    m_prefetchBehind = settings.value("prefetchBehind", 1).toInt();
+    m_prefetchAhead  = settings.value("prefetchAhead", 2).toInt();
+    m_prefetchLead   = settings.value("prefetchLead", 1000).toInt();
+    m_pScheduler->setPrefetchLead(m_prefetchLead);
+    WallpaperCache::instance()->setLimit(settings.value("diskCacheLimit", 512).toLongLong() * 1024 * 1024);
+    MemoryBudget::instance()->setLimit(settings.value("memoryBudget", 256).toLongLong() * 1024 * 1024);
     m_pCharacterLbl->setFont(settings.value("characteFont").value<QFont>());
     m_pCharacterLbl->setColor(settings.value("characteColor").value<QColor>());
     m_pTaskbarControl->setColor(settings.value("taskBarColor").value<QColor>());
@@ -555,13 +962,13 @@ void MainWindow::closeEvent(QCloseEvent *event)
 
 bool MainWindow::eventFilter(QObject *object, QEvent *event)
 {
-    if (object == m_pImageLbl || object == m_pMovieLbl || object == m_pVedioLbl)
+    if (object != nullptr && object == m_pSurface)
     {
         switch (event->type())
         {
         case QEvent::Show:
-            m_pCharacterLbl->setParent(qobject_cast<QWidget*>(object));
-            if (m_pCharacterVisibleBox->isChecked() && object != m_pVedioLbl)
+            m_pCharacterLbl->setParent(m_pSurface);
+            if (m_pCharacterVisibleBox->isChecked() && m_pVedioLbl == nullptr)
                 m_pCharacterLbl->show();
             break;
         case QEvent::Hide:
@@ -581,38 +988,117 @@ bool MainWindow::eventFilter(QObject *object, QEvent *event)
 
 void MainWindow::onSelectResourcesBtnClicked()
 {
+    if (m_pResourcesFolderRadioBtn->isChecked())
+    {
+        QString dir = QFileDialog::getExistingDirectory(this, QStringLiteral("选择图片文件夹"), m_folderPath);
+        if (!dir.isEmpty())
+        {
+            m_folderPath = dir;
+            m_playlist.setEntries(QStringList());
+            loadResourcesFile();
+        }
+        return;
+    }
+
     QFileDialog fd(this);
 
     fd.setWindowIcon(QIcon(":/image/image/logo.ico"));
     fd.setWindowTitle(QStringLiteral("选择资源文件"));
     fd.setAcceptMode(QFileDialog::AcceptOpen);
 
+    // 多个文件轮播时动画和视频条目同样按各自的方式播放
     QStringList fileFilters;
-    fileFilters.append("图片文件(*.jpg *.jpeg *.jpe *.jfif *.png *.ico)");
+    fileFilters.append("图片文件(*.jpg *.jpeg *.jpe *.jfif *.png *.ico *.bmp *.webp *.heic *.heif *.avif)");
+    fileFilters.append("动画文件(*.gif *.webp *.png *.apng)");
+    fileFilters.append("视频文件(*.flv *.rmvb *.avi *.mp4 *.mkv *.webm *.mov)");
 
-    if (m_pResourcesFileRadioBtn->isChecked())
-    {
-        fileFilters.append("动画文件(*.gif)");
-        fileFilters.append("视频文件(*.flv *.rmvb *.avi *.mp4 *.mkv)");
-        fd.setFileMode(QFileDialog::ExistingFile);
-    }
-    else
-    {
-        fd.setFileMode(QFileDialog::ExistingFiles);
-    }
+    fd.setFileMode(m_pResourcesFileRadioBtn->isChecked() ? QFileDialog::ExistingFile : QFileDialog::ExistingFiles);
 
     fd.setNameFilters(fileFilters);
 
     if (fd.exec() == QFileDialog::Accepted)
     {
-        m_filesPath = fd.selectedFiles();
+        m_playlist.setEntries(fd.selectedFiles());
+        m_folderPath.clear();
         loadResourcesFile();
     }
 }
 
+void MainWindow::onSlideshowCurrentChanged(const QImage &image)
+{
+    // 首张图片解码完成后才替换旧壁纸；壁纸缓冲中是旧壁纸或上一条目动画的最后一帧时从它过渡过来，视频画面不在缓冲中
+    const bool fromBuffer = m_pSurface != nullptr && m_pPreviousVedioLbl == nullptr && m_pVedioLbl == nullptr;
+
+    createSurface();
+    stopSlideMedia();
+    finishSwitch();
+
+    // 先确定本条目的显示时长，平移缩放的动画时长与它一致
+    scheduleSlideshow();
+
+    // 过渡从平移缩放的当前画面开始，过渡结束后新图片再开始平移缩放；上一次过渡未结束时从过渡中的画面继续
+    m_pKenBurns->stop();
+
+    if (!fromBuffer || !m_pTransition->start(m_pSurface->buffer(), image))
+    {
+        m_pSurface->setImage(image);
+        startKenBurns(image);
+    }
+
+    showSurface();
+}
+
+void MainWindow::onSlideshowMediaChanged(const QString &file, MediaRegistry::Kind kind)
+{
+    // 轮播中的动画和视频按单个文件的方式播放到本条目的显示时间结束，第一帧就绪前画面保持不变
+    stopSlideMedia();
+    m_pKenBurns->stop();
+    m_pTransition->stop();
+
+    if (kind == MediaRegistry::MovieKind)
+        createMovieWallpaper(file);
+    else
+        createVideoWallpaper(file);
+
+    scheduleSlideshow();
+
+    if (!m_pVisibility->isVisible())
+        suspendRendering(true);
+}
+
+void MainWindow::onVisibilityChanged(bool visible)
+{
+    suspendRendering(!visible);
+}
+
 void MainWindow::onSysTrayAboutActionTrigger()
 {
     QMessageBox message(this);
+    WallpaperCache::Statistics cache = WallpaperCache::instance()->statistics();
+    QMap<QString, qint64> memory = MemoryBudget::instance()->usageByConsumer();
+    TransitionEngine::Statistics transition = m_pTransition->statistics();
+    ImageSlideshow::Statistics slideshow = m_pSlideshow->statistics();
+    AnimationPlayer::Statistics animation = { 0, 0, 0, 0, 0, 0, false, 0, 0.0, 0 };
+    JitterHistogram jitter;
+
+    if (m_pAnimation != nullptr)
+    {
+        animation = m_pAnimation->statistics();
+        jitter = m_pAnimation->jitter();
+    }
+
+    QStringList memoryUsage;
+    for (auto it = memory.constBegin(); it != memory.constEnd(); ++it)
+        memoryUsage.append(QStringLiteral("%1 %2 MB").arg(it.key()).arg(it.value() / (1024 * 1024)));
+
+    // 各电源模式下实测的每分钟处理器时间，未运行过的模式不显示
+    QStringList cpuUsage;
+    for (int profile = 0; profile < PowerProfile::ProfileCount; ++profile)
+    {
+        double msec = m_pPowerProfile->cpuPerMinute(PowerProfile::Profile(profile));
+        if (msec >= 0)
+            cpuUsage.append(QStringLiteral("%1 %2 ms").arg(PowerProfile::name(PowerProfile::Profile(profile))).arg(msec, 0, 'f', 0));
+    }
 
     showMinimized();
 
@@ -624,14 +1110,80 @@ void MainWindow::onSysTrayAboutActionTrigger()
                                    "简单桌面是一款便捷灵活的桌面壁纸管理软件\n"
                                    "此应用不会收集任何用户信息，甚至不会访问系统网络,"
                                    "为了使用安全，请前往作者网站页下载\n"
-                                   "问题及使用建议反馈：1508539502@qq.com"));
+                                   "问题及使用建议反馈：1508539502@qq.com\n\n"
+                                   "壁纸缓存：命中 %1 次，未命中 %2 次，占用 %3 / %4 MB，内容去重共用 %11 次（%12%）\n"
+                                   "内存预算：%5 / %6 MB（%7）\n"
+                                   "切换特效：%8 次切换，呈现 %9 帧，丢弃 %10 帧\n"
+                                   "电源模式：%13，每分钟处理器时间 %14\n"
+                                   "壁纸切换：%15 次，平均 %16 ms，最长 %17 ms\n"
+                                   "动画壁纸：解码 %18 帧，呈现 %19 帧，晚到 %20 帧，帧队列 %21 / %22，"
+                                   "帧缓存 %23 MB（压缩 %24 帧，平均展开 %25 ms）\n"
+                                   "动画计时：跳过 %26 帧，抖动中位 %27 ms，95% %28 ms，最大 %29 ms\n"
+                                   "轮播切换：%30 次，界面线程平均 %31 ms，最长 %32 ms")
+                    .arg(cache.hits).arg(cache.misses).arg(cache.size / (1024 * 1024)).arg(cache.limit / (1024 * 1024))
+                    .arg(MemoryBudget::instance()->usage() / (1024 * 1024)).arg(MemoryBudget::instance()->limit() / (1024 * 1024))
+                    .arg(memoryUsage.join(QStringLiteral("，")))
+                    .arg(transition.transitions).arg(transition.framesPresented).arg(transition.framesDropped)
+                    .arg(cache.dedupHits).arg(cache.dedupRate * 100, 0, 'f', 1)
+                    .arg(PowerProfile::name(m_pPowerProfile->profile())).arg(cpuUsage.join(QStringLiteral("，")))
+                    .arg(m_switchCount).arg(m_switchCount > 0 ? m_switchTotal / m_switchCount : 0).arg(m_switchMax)
+                    .arg(animation.framesDecoded).arg(animation.framesPresented).arg(animation.framesLate)
+                    .arg(animation.queueDepth).arg(animation.queueCapacity)
+                    .arg(animation.storeBytes / (1024 * 1024)).arg(animation.compressedFrames).arg(animation.expandMs, 0, 'f', 2)
+                    .arg(animation.framesSkipped).arg(jitter.percentile(0.5), 0, 'f', 1)
+                    .arg(jitter.percentile(0.95), 0, 'f', 1).arg(jitter.maximum(), 0, 'f', 1)
+                    .arg(slideshow.switches).arg(slideshow.averageMs, 0, 'f', 2).arg(slideshow.maxMs, 0, 'f', 2));
+
+    // 动画壁纸的帧计时可导出为 JSON，用于对比不同构建
+    QPushButton *pExportBtn = nullptr;
+    if (m_pAnimation != nullptr)
+    {
+        pExportBtn = message.addButton(QStringLiteral("导出帧计时"), QMessageBox::ActionRole);
+        message.addButton(QMessageBox::Ok);
+    }
 
     message.exec();
 
+    if (pExportBtn != nullptr && message.clickedButton() == pExportBtn)
+        exportAnimationTiming();
+
     showNormal();
     hide();
 }
 
+void MainWindow::exportAnimationTiming()
+{
+    if (m_pAnimation == nullptr)
+        return;
+
+    QString path = QFileDialog::getSaveFileName(this, QStringLiteral("导出帧计时"),
+                                                QStringLiteral("animation-timing.json"), QStringLiteral("JSON 文件(*.json)"));
+    if (path.isEmpty())
+        return;
+
+    AnimationPlayer::Statistics statistics = m_pAnimation->statistics();
+    QJsonObject frames;
+    frames.insert("decoded", statistics.framesDecoded);
+    frames.insert("presented", statistics.framesPresented);
+    frames.insert("skipped", statistics.framesSkipped);
+    frames.insert("late", statistics.framesLate);
+    frames.insert("compressed", statistics.compressedFrames);
+
+    QJsonObject report;
+    report.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("version", QStringLiteral("1.2.31"));
+    report.insert("qtVersion", QString::fromLatin1(qVersion()));
+    report.insert("file", m_playlist.count() == 1 ? m_playlist.at(0) : QString());
+    report.insert("powerProfile", PowerProfile::name(m_pPowerProfile->profile()));
+    report.insert("stored", statistics.stored);
+    report.insert("frames", frames);
+    report.insert("jitter", m_pAnimation->jitter().toJson());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(report).toJson()) < 0)
+        QMessageBox::warning(this, QStringLiteral("导出帧计时"), QStringLiteral("无法写入文件：%1").arg(path));
+}
+
 void MainWindow::onSysTrayHelpActionTrigger()
 {
     QMessageBox message(this);
@@ -656,7 +1208,7 @@ void MainWindow::onCharacteLblMove()
 
 void MainWindow::onCharacteLblCheckShow(bool sta)
 {
-    if (m_pMovieLbl != nullptr || m_pImageLbl != nullptr)
+    if (m_pSurface != nullptr && m_pVedioLbl == nullptr)
         m_pCharacterLbl->setVisible(sta);
 }
 
@@ -4,6 +4,8 @@
 #include <QAction>
 #include <QCheckBox>
 #include <QColor>
+#include <QComboBox>
+#include <QElapsedTimer>
 #include <QGroupBox>
 #include <QLabel>
 #include <QLineEdit>
@@ -21,8 +23,18 @@
 #include <VLCQtWidgets/WidgetVideo.h>
 #include <VLCQtCore/Instance.h>
 
+#include "animationplayer.h"
 #include "characterlabel.h"
+#include "folderindexer.h"
+#include "imageslideshow.h"
+#include "kenburnsanimator.h"
+#include "playlist.h"
+#include "powerprofile.h"
+#include "slideshowscheduler.h"
 #include "taskbarcontrol.h"
+#include "transitionengine.h"
+#include "visibilitymonitor.h"
+#include "wallpapersurface.h"
 
 class MainWindow : public QWidget
 {
@@ -40,6 +52,9 @@ protected:
 
 protected slots:
     void onSelectResourcesBtnClicked();
+    void onSlideshowCurrentChanged(const QImage &image);
+    void onSlideshowMediaChanged(const QString &file, MediaRegistry::Kind kind);
+    void onVisibilityChanged(bool visible);
     void onSysTrayAboutActionTrigger();
     void onSysTrayHelpActionTrigger();
 
@@ -54,18 +69,35 @@ private:
     bool loadResourcesFile();
     HWND findDeskTopWindow();
     void removeAllWallpaper();
-    void createImageWallpaper(const QStringList &files);
+    void beginSwitch();
+    void finishSwitch();
+    void abortSwitch(const QString &file);
+    void updateWallpaperSize();
+    void createSurface();
+    void showSurface();
+    void createImageWallpaper();
+    void startKenBurns(const QImage &image);
+    void scheduleSlideshow();
+    void stopSlideMedia();
+    void createFolderWallpaper(const QString &dir);
     void createMovieWallpaper(const QString &file);
     void createVideoWallpaper(const QString &file);
     void createDefaultWallpaper(const QString &filePath);
+    void suspendRendering(bool suspended);
+    void applyPowerProfile();
+    void exportAnimationTiming();
     void saveState();
     void restoreState();
 
 private:
     QRadioButton *m_pResourcesFilesRadioBtn = nullptr;
     QRadioButton *m_pResourcesFileRadioBtn  = nullptr;
+    QRadioButton *m_pResourcesFolderRadioBtn = nullptr;
     QPushButton *m_pSelectResourcesBtn      = nullptr;
     QSpinBox *m_pTimeIntervalSpinBox        = nullptr;
+    QComboBox *m_pTransitionBox             = nullptr;
+    QCheckBox *m_pShuffleBox                = nullptr;
+    QCheckBox *m_pKenBurnsBox               = nullptr;
     QSlider *m_pVolumeSlider                = nullptr;
     CharacterLabel *m_pCharacterLbl         = nullptr;
     QCheckBox *m_pCharacterVisibleBox       = nullptr;
@@ -81,21 +113,42 @@ private:
     QPushButton *m_pTaskBarColorBtn = nullptr;
     QSlider     *m_pTaskBarAlphaSlider    = nullptr;
     QCheckBox *m_pAutoRuningCheckBox        = nullptr;
+    QComboBox *m_pPowerModeBox              = nullptr;
     QSystemTrayIcon *m_pTrayIcon            = nullptr;
     QAction *m_pSysTraySetAction            = nullptr;
     QAction *m_pSysTrayAboutAction          = nullptr;
     QAction *m_pSysTrayHelpAction           = nullptr;
     QAction *m_pSysTrayExitAction           = nullptr;
 
-    QLabel *m_pMovieLbl         = nullptr;
-    QLabel *m_pImageLbl         = nullptr;
-    VlcWidgetVideo *m_pVedioLbl = nullptr;
+    WallpaperSurface *m_pSurface  = nullptr;
+    AnimationPlayer *m_pAnimation = nullptr;
+    VlcWidgetVideo *m_pVedioLbl   = nullptr;    // 视频壁纸时为 m_pSurface 的子窗口
 
-    QStringList m_filesPath;
-    QList<QPixmap> m_images;
-    int m_imageIndex = 0;
+    // 切换壁纸时旧壁纸继续显示，新壁纸的第一帧就绪后再释放
+    AnimationPlayer *m_pPreviousAnimation = nullptr;
+    VlcWidgetVideo *m_pPreviousVedioLbl   = nullptr;
+    bool m_switching = false;
+    QElapsedTimer m_switchClock;
+    int m_switchCount = 0;
+    qint64 m_switchTotal = 0;                   // 从开始切换到新壁纸第一帧的耗时，毫秒
+    qint64 m_switchMax = 0;
+
+    Playlist m_playlist;
+    QString m_folderPath;
+    ImageSlideshow *m_pSlideshow = new ImageSlideshow(this);
+    SlideshowScheduler *m_pScheduler = new SlideshowScheduler(this);
+    quint32 m_shuffleSeed = 0;
+    int m_kenBurnsFps = 30;                     // 用户设置的上限，实际帧率再受电源模式限制
+    int m_prefetchBehind = 1;
+    int m_prefetchAhead = 2;
+    int m_prefetchLead = 1000;                  // 预取的最小提前量，解码较慢时调度器按解码耗时加大
+    FolderIndexer *m_pFolderIndexer = new FolderIndexer(this);
+    TransitionEngine *m_pTransition = new TransitionEngine(this);
+    KenBurnsAnimator *m_pKenBurns = new KenBurnsAnimator(this);
     VlcInstance *m_pInstance = nullptr;
     VlcMediaPlayer*m_pPlayer = nullptr;
     TaskbarControl *m_pTaskbarControl = new TaskbarControl(this);
+    VisibilityMonitor *m_pVisibility = new VisibilityMonitor(this);
+    PowerProfile *m_pPowerProfile = new PowerProfile(this);
 };
 #endif // MAINWINDOW_H
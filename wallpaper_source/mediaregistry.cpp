@@ -0,0 +1,172 @@
+#include "mediaregistry.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace
+{
+// 与 MediaRegistry::Format 一一对应，按下标访问
+const MediaRegistry::Handler Handlers[MediaRegistry::FormatCount] =
+{
+    { MediaRegistry::UnknownFormat,      MediaRegistry::UnknownKind, 0,                                                    nullptr },
+    { MediaRegistry::JpegFormat,         MediaRegistry::ImageKind,   MediaRegistry::StillImage | MediaRegistry::ScaledDecode, "jpeg" },
+    { MediaRegistry::PngFormat,          MediaRegistry::ImageKind,   MediaRegistry::StillImage,                           "png" },
+    { MediaRegistry::GifFormat,          MediaRegistry::MovieKind,   MediaRegistry::StillImage | MediaRegistry::Animation, "gif" },
+    { MediaRegistry::BmpFormat,          MediaRegistry::ImageKind,   MediaRegistry::StillImage,                           "bmp" },
+    { MediaRegistry::IcoFormat,          MediaRegistry::ImageKind,   MediaRegistry::StillImage,                           "ico" },
+    { MediaRegistry::WebpFormat,         MediaRegistry::ImageKind,   MediaRegistry::StillImage,                           "webp" },
+    { MediaRegistry::AnimatedWebpFormat, MediaRegistry::MovieKind,   MediaRegistry::StillImage | MediaRegistry::Animation, "webp" },
+    { MediaRegistry::ApngFormat,         MediaRegistry::MovieKind,   MediaRegistry::StillImage | MediaRegistry::Animation, "png" },
+    { MediaRegistry::HeifFormat,         MediaRegistry::ImageKind,   MediaRegistry::StillImage,                           "heif" },
+    { MediaRegistry::AvifFormat,         MediaRegistry::ImageKind,   MediaRegistry::StillImage,                           "avif" },
+    { MediaRegistry::Mp4Format,          MediaRegistry::VideoKind,   MediaRegistry::Animation | MediaRegistry::Audio,      nullptr },
+    { MediaRegistry::MatroskaFormat,     MediaRegistry::VideoKind,   MediaRegistry::Animation | MediaRegistry::Audio,      nullptr },
+    { MediaRegistry::AviFormat,          MediaRegistry::VideoKind,   MediaRegistry::Animation | MediaRegistry::Audio,      nullptr },
+    { MediaRegistry::FlvFormat,          MediaRegistry::VideoKind,   MediaRegistry::Animation | MediaRegistry::Audio,      nullptr },
+    { MediaRegistry::RealMediaFormat,    MediaRegistry::VideoKind,   MediaRegistry::Animation | MediaRegistry::Audio,      nullptr },
+};
+
+bool startsWith(const QByteArray &head, int offset, const char *magic, int length)
+{
+    return head.size() >= offset + length && memcmp(head.constData() + offset, magic, size_t(length)) == 0;
+}
+
+bool hasBrand(const QByteArray &head, const char *const *brands, int count)
+{
+    // 主品牌在第 8 字节，兼容品牌从第 16 字节排到 ftyp 盒结束，只检查读入的文件头范围内的部分
+    const int end = qMin(head.size(), int(qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(head.constData()))));
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (startsWith(head, 8, brands[i], 4))
+            return true;
+
+        for (int offset = 16; offset + 4 <= end; offset += 4)
+            if (startsWith(head, offset, brands[i], 4))
+                return true;
+    }
+
+    return false;
+}
+
+MediaRegistry::Format isoFormat(const QByteArray &head)
+{
+    // HEIF、AVIF 静态图片与 MP4、MOV 视频同为 ISO 媒体封装，按 ftyp 中的品牌区分
+    static const char *const AvifBrands[] = { "avif", "avis" };
+    static const char *const HeifBrands[] = { "heic", "heix", "heim", "heis", "hevc", "hevx", "mif1", "msf1" };
+
+    if (hasBrand(head, AvifBrands, 2))
+        return MediaRegistry::AvifFormat;
+    if (hasBrand(head, HeifBrands, 8))
+        return MediaRegistry::HeifFormat;
+
+    return MediaRegistry::Mp4Format;
+}
+}
+
+MediaRegistry::Format MediaRegistry::sniff(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return UnknownFormat;
+
+    Format format = sniff(file.read(SniffLength));
+
+    // APNG 与静态 PNG 的文件头相同，要看 acTL 块是否出现在图像数据之前
+    if (format == PngFormat && isAnimatedPng(&file))
+        return ApngFormat;
+
+    // 魔数无法识别的文件（例如部分视频封装）再按扩展名兜底
+    return format != UnknownFormat ? format : formatFromSuffix(path);
+}
+
+MediaRegistry::Format MediaRegistry::sniff(const QByteArray &head)
+{
+    if (startsWith(head, 0, "\xFF\xD8\xFF", 3))
+        return JpegFormat;
+    if (startsWith(head, 0, "\x89PNG\r\n\x1A\n", 8))
+        return PngFormat;
+    if (startsWith(head, 0, "GIF87a", 6) || startsWith(head, 0, "GIF89a", 6))
+        return GifFormat;
+    if (startsWith(head, 0, "BM", 2))
+        return BmpFormat;
+    if (startsWith(head, 0, "\x00\x00\x01\x00", 4))
+        return IcoFormat;
+
+    if (startsWith(head, 0, "RIFF", 4))
+    {
+        if (startsWith(head, 8, "WEBP", 4))
+        {
+            // VP8X 扩展头第 20 字节的动画标志位
+            bool animated = startsWith(head, 12, "VP8X", 4) && head.size() > 20 && (head.at(20) & 0x02);
+            return animated ? AnimatedWebpFormat : WebpFormat;
+        }
+
+        if (startsWith(head, 8, "AVI ", 4))
+            return AviFormat;
+    }
+
+    if (startsWith(head, 4, "ftyp", 4))
+        return isoFormat(head);
+    if (startsWith(head, 0, "\x1A\x45\xDF\xA3", 4))
+        return MatroskaFormat;
+    if (startsWith(head, 0, "FLV", 3))
+        return FlvFormat;
+    if (startsWith(head, 0, ".RMF", 4))
+        return RealMediaFormat;
+
+    return UnknownFormat;
+}
+
+const MediaRegistry::Handler &MediaRegistry::handler(Format format)
+{
+    return Handlers[format >= 0 && format < FormatCount ? format : UnknownFormat];
+}
+
+const MediaRegistry::Handler &MediaRegistry::handlerForFile(const QString &path)
+{
+    return handler(sniff(path));
+}
+
+MediaRegistry::Format MediaRegistry::formatFromSuffix(const QString &path)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+
+    if (suffix == QLatin1String("mp4") || suffix == QLatin1String("mov") || suffix == QLatin1String("m4v"))
+        return Mp4Format;
+    if (suffix == QLatin1String("mkv") || suffix == QLatin1String("webm"))
+        return MatroskaFormat;
+    if (suffix == QLatin1String("avi"))
+        return AviFormat;
+    if (suffix == QLatin1String("flv"))
+        return FlvFormat;
+    if (suffix == QLatin1String("rmvb") || suffix == QLatin1String("rm"))
+        return RealMediaFormat;
+
+    return UnknownFormat;
+}
+
+bool MediaRegistry::isAnimatedPng(QIODevice *device)
+{
+    // 只读取块头并跳过块数据，IHDR 之后通常几十字节内即可确定
+    qint64 offset = 8;
+    for (int i = 0; i < 64 && device->seek(offset); ++i)
+    {
+        const QByteArray head = device->read(8);
+        if (head.size() < 8)
+            return false;
+
+        const char *type = head.constData() + 4;
+        if (memcmp(type, "acTL", 4) == 0)
+            return true;
+        if (memcmp(type, "IDAT", 4) == 0 || memcmp(type, "IEND", 4) == 0)
+            return false;
+
+        offset += qint64(qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(head.constData()))) + 12;
+    }
+
+    return false;
+}
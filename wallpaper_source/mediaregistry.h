@@ -0,0 +1,75 @@
+#ifndef MEDIAREGISTRY_H
+#define MEDIAREGISTRY_H
+
+#include <QByteArray>
+#include <QFlags>
+#include <QString>
+
+class QIODevice;
+
+// 媒体类型注册表：根据文件头魔数识别格式，按格式下标直接查表得到对应的壁纸处理方式
+class MediaRegistry
+{
+public:
+    enum Format
+    {
+        UnknownFormat = 0,
+        JpegFormat,
+        PngFormat,
+        GifFormat,
+        BmpFormat,
+        IcoFormat,
+        WebpFormat,
+        AnimatedWebpFormat,
+        ApngFormat,
+        HeifFormat,
+        AvifFormat,
+        Mp4Format,
+        MatroskaFormat,
+        AviFormat,
+        FlvFormat,
+        RealMediaFormat,
+        FormatCount
+    };
+
+    enum Kind
+    {
+        UnknownKind = 0,
+        ImageKind,                              // 静态图片，可参与多图片轮播
+        MovieKind,                              // 动画图片
+        VideoKind                               // 视频，交给 VLC 播放
+    };
+
+    enum Capability
+    {
+        StillImage   = 0x1,                     // 可解码为单张图片
+        Animation    = 0x2,                     // 包含多帧动画
+        ScaledDecode = 0x4,                     // 解码阶段即可缩小
+        Audio        = 0x8                      // 可能包含音轨
+    };
+    Q_DECLARE_FLAGS(Capabilities, Capability)
+
+    struct Handler
+    {
+        Format format;
+        Kind kind;
+        Capabilities capabilities;
+        const char *readerFormat;               // QImageReader 使用的格式名，视频为空
+    };
+
+    static constexpr int SniffLength = 32;
+
+    static Format sniff(const QString &path);
+    static Format sniff(const QByteArray &head);
+
+    static const Handler &handler(Format format);
+    static const Handler &handlerForFile(const QString &path);
+
+private:
+    static Format formatFromSuffix(const QString &path);
+    static bool isAnimatedPng(QIODevice *device);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(MediaRegistry::Capabilities)
+
+#endif // MEDIAREGISTRY_H
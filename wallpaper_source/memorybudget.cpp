@@ -0,0 +1,110 @@
+#include "memorybudget.h"
+
+#include <algorithm>
+
+MemoryBudget *MemoryBudget::instance()
+{
+    static MemoryBudget budget;
+    return &budget;
+}
+
+MemoryBudget::MemoryBudget(QObject *parent) : QObject(parent)
+{ }
+
+void MemoryBudget::setLimit(qint64 bytes)
+{
+    m_limit = qMax<qint64>(0, bytes);
+
+    if (usage() > m_limit)
+        release(usage() - m_limit, nullptr);
+
+    emit usageChanged();
+}
+
+qint64 MemoryBudget::limit() const
+{
+    return m_limit;
+}
+
+void MemoryBudget::registerConsumer(MemoryConsumer *consumer)
+{
+    if (!m_consumers.contains(consumer))
+        m_consumers.append(consumer);
+}
+
+void MemoryBudget::unregisterConsumer(MemoryConsumer *consumer)
+{
+    m_consumers.removeAll(consumer);
+}
+
+void MemoryBudget::setReserved(const QString &name, qint64 bytes)
+{
+    if (bytes > 0)
+        m_reserved.insert(name, bytes);
+    else
+        m_reserved.remove(name);
+
+    emit usageChanged();
+}
+
+qint64 MemoryBudget::usage() const
+{
+    qint64 total = 0;
+
+    for (auto consumer : m_consumers)
+        total += consumer->memoryUsage();
+
+    for (auto bytes : m_reserved)
+        total += bytes;
+
+    return total;
+}
+
+qint64 MemoryBudget::available() const
+{
+    return qMax<qint64>(0, m_limit - usage());
+}
+
+QMap<QString, qint64> MemoryBudget::usageByConsumer() const
+{
+    QMap<QString, qint64> result = m_reserved;
+
+    for (auto consumer : m_consumers)
+        result[consumer->memoryName()] += consumer->memoryUsage();
+
+    return result;
+}
+
+bool MemoryBudget::reserve(qint64 bytes, MemoryConsumer *requester)
+{
+    qint64 over = usage() + bytes - m_limit;
+
+    if (over > 0)
+        over -= release(over, requester);
+
+    emit usageChanged();
+
+    return over <= 0;
+}
+
+qint64 MemoryBudget::release(qint64 bytes, MemoryConsumer *requester)
+{
+    // 低优先级的使用者先淘汰；申请者自身放在同优先级的最后
+    QList<MemoryConsumer*> order = m_consumers;
+    std::stable_sort(order.begin(), order.end(), [=](MemoryConsumer *a, MemoryConsumer *b){
+        if (a->memoryPriority() != b->memoryPriority())
+            return a->memoryPriority() < b->memoryPriority();
+        return a != requester && b == requester;
+    });
+
+    qint64 released = 0;
+    for (auto consumer : order)
+    {
+        if (released >= bytes)
+            break;
+
+        released += consumer->releaseMemory(bytes - released);
+    }
+
+    return released;
+}
@@ -0,0 +1,65 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+
+// 可淘汰的内存使用者：按优先级在使用者之间淘汰，使用者内部按最近最少使用淘汰
+class MemoryConsumer
+{
+public:
+    enum Priority
+    {
+        PrefetchPriority  = 0,                  // 预取数据，最先淘汰
+        CachePriority     = 50,                 // 可重新生成的缓存
+        DisplayPriority   = 100                 // 正在显示的数据
+    };
+
+    virtual ~MemoryConsumer() = default;
+
+    virtual QString memoryName() const = 0;
+    virtual qint64 memoryUsage() const = 0;
+    virtual int memoryPriority() const = 0;
+    virtual qint64 releaseMemory(qint64 bytes) = 0;
+};
+
+// 全局内存预算：图片缓存、动画帧缓存和视频缓冲统一登记，超出预算时按优先级淘汰
+class MemoryBudget : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MemoryBudget *instance();
+
+    void setLimit(qint64 bytes);
+    qint64 limit() const;
+
+    void registerConsumer(MemoryConsumer *consumer);
+    void unregisterConsumer(MemoryConsumer *consumer);
+
+    // 不可淘汰的占用（例如 VLC 视频缓冲）只登记估算大小
+    void setReserved(const QString &name, qint64 bytes);
+
+    qint64 usage() const;
+    qint64 available() const;
+    QMap<QString, qint64> usageByConsumer() const;
+
+    bool reserve(qint64 bytes, MemoryConsumer *requester = nullptr);
+
+signals:
+    void usageChanged();
+
+private:
+    explicit MemoryBudget(QObject *parent = nullptr);
+
+    qint64 release(qint64 bytes, MemoryConsumer *requester);
+
+private:
+    QList<MemoryConsumer*> m_consumers;
+    QMap<QString, qint64> m_reserved;
+    qint64 m_limit = 256 * 1024 * 1024;
+};
+
+#endif // MEMORYBUDGET_H
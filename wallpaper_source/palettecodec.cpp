@@ -0,0 +1,202 @@
+#include "palettecodec.h"
+
+#include <QVector>
+
+#include <cstring>
+
+#include "pixelkernels.h"
+
+namespace
+{
+struct Header
+{
+    qint32 width;
+    qint32 height;
+    qint32 colors;
+};
+
+const int MaxLiteral = 128;                     // 控制字节 0 ~ 127：其后 n + 1 个原样的下标
+const int MinRun     = 3;                       // 控制字节 128 ~ 255：下一个下标重复 n - 125 次
+const int MaxRun     = 130;
+
+// 开放寻址的颜色表，超过 256 种颜色时放弃
+class ColorTable
+{
+public:
+    ColorTable()
+    {
+        memset(m_used, 0, sizeof(m_used));
+    }
+
+    int indexOf(quint32 color)
+    {
+        quint32 slot = (color * 2654435761u) >> 23;
+
+        while (m_used[slot])
+        {
+            if (m_keys[slot] == color)
+                return m_values[slot];
+            slot = (slot + 1) & (Slots - 1);
+        }
+
+        if (m_count == 256)
+            return -1;
+
+        m_used[slot]   = true;
+        m_keys[slot]   = color;
+        m_values[slot] = uchar(m_count);
+        m_palette[m_count] = color;
+
+        return m_count++;
+    }
+
+    int count() const
+    {
+        return m_count;
+    }
+
+    const quint32 *palette() const
+    {
+        return m_palette;
+    }
+
+private:
+    static const int Slots = 512;
+
+    bool m_used[Slots];
+    quint32 m_keys[Slots];
+    uchar m_values[Slots];
+    quint32 m_palette[256];
+    int m_count = 0;
+};
+
+void appendLiteral(QByteArray &out, const uchar *data, int count)
+{
+    while (count > 0)
+    {
+        const int n = qMin(count, MaxLiteral);
+        out.append(char(n - 1));
+        out.append(reinterpret_cast<const char*>(data), n);
+        data  += n;
+        count -= n;
+    }
+}
+}
+
+QByteArray PaletteCodec::pack(const QImage &image)
+{
+    if (image.isNull() || image.depth() != 32)
+        return QByteArray();
+
+    const int width  = image.width();
+    const int height = image.height();
+    QByteArray indices(width * height, Qt::Uninitialized);
+    uchar *index = reinterpret_cast<uchar*>(indices.data());
+    ColorTable colors;
+
+    for (int y = 0; y < height; ++y)
+    {
+        const quint32 *line = reinterpret_cast<const quint32*>(image.constScanLine(y));
+        for (int x = 0; x < width; ++x)
+        {
+            const int value = colors.indexOf(line[x]);
+            if (value < 0)
+                return QByteArray();
+            *index++ = uchar(value);
+        }
+    }
+
+    const Header header = { width, height, colors.count() };
+    QByteArray out;
+    out.reserve(int(sizeof(header)) + colors.count() * 4 + indices.size() / 4);
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(reinterpret_cast<const char*>(colors.palette()), colors.count() * 4);
+
+    // 行与行首尾相连，整块区域作为一个下标序列编码
+    const uchar *data = reinterpret_cast<const uchar*>(indices.constData());
+    const int count = indices.size();
+    int literal = 0;                            // 尚未写出的原样下标的起点
+
+    for (int i = 0; i < count; )
+    {
+        int run = 1;
+        while (i + run < count && run < MaxRun && data[i + run] == data[i])
+            ++run;
+
+        if (run < MinRun)
+        {
+            i += run;
+            continue;
+        }
+
+        appendLiteral(out, data + literal, i - literal);
+        out.append(char(run + 125));
+        out.append(char(data[i]));
+
+        i += run;
+        literal = i;
+    }
+
+    appendLiteral(out, data + literal, count - literal);
+
+    // 压缩后不比原始像素小时不值得展开的开销
+    if (out.size() >= image.sizeInBytes())
+        return QByteArray();
+
+    return out;
+}
+
+bool PaletteCodec::unpack(const QByteArray &packed, QImage *image)
+{
+    Header header;
+    if (packed.size() < int(sizeof(header)))
+        return false;
+
+    memcpy(&header, packed.constData(), sizeof(header));
+    if (header.width <= 0 || header.height <= 0 || header.colors <= 0 || header.colors > 256
+        || packed.size() < int(sizeof(header)) + header.colors * 4)
+        return false;
+
+    // 调色板补满 256 项，损坏的下标也不会越界
+    quint32 palette[256] = { };
+    memcpy(palette, packed.constData() + sizeof(header), size_t(header.colors) * 4);
+
+    const uchar *in  = reinterpret_cast<const uchar*>(packed.constData()) + sizeof(header) + header.colors * 4;
+    const uchar *end = reinterpret_cast<const uchar*>(packed.constData()) + packed.size();
+    const int count  = header.width * header.height;
+
+    QVector<uchar> indices(count);
+    uchar *out = indices.data();
+    int filled = 0;
+
+    while (in < end && filled < count)
+    {
+        const int control = *in++;
+
+        if (control < MaxLiteral)
+        {
+            const int n = qMin(control + 1, qMin(int(end - in), count - filled));
+            memcpy(out + filled, in, size_t(n));
+            in     += n;
+            filled += n;
+        }
+        else if (in < end)
+        {
+            const int n = qMin(control - 125, count - filled);
+            memset(out + filled, *in++, size_t(n));
+            filled += n;
+        }
+    }
+
+    if (filled != count)
+        return false;
+
+    const QSize size(header.width, header.height);
+    if (image->size() != size || image->format() != QImage::Format_ARGB32_Premultiplied)
+        *image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+
+    for (int y = 0; y < header.height; ++y)
+        PixelKernels::expandPalette(out + y * header.width, palette, reinterpret_cast<quint32*>(image->scanLine(y)), header.width);
+
+    return true;
+}
@@ -0,0 +1,16 @@
+#ifndef PALETTECODEC_H
+#define PALETTECODEC_H
+
+#include <QByteArray>
+#include <QImage>
+
+// 动画帧的压缩存储：不超过 256 种颜色的区域保存为调色板下标，下标再做游程编码
+// 显示时先解出下标，再按调色板展开为 32 位像素
+class PaletteCodec
+{
+public:
+    static QByteArray pack(const QImage &image);
+    static bool unpack(const QByteArray &packed, QImage *image);
+};
+
+#endif // PALETTECODEC_H
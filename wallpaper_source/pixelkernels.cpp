@@ -0,0 +1,449 @@
+#include "pixelkernels.h"
+
+#include <QAtomicInt>
+
+#if defined(Q_PROCESSOR_X86)
+#  include <immintrin.h>
+#  if defined(Q_CC_MSVC)
+#    include <intrin.h>
+#  endif
+#endif
+
+#if defined(Q_CC_GNU) || defined(Q_CC_CLANG)
+#  define KERNEL_TARGET(arch) __attribute__((target(arch)))
+#else
+#  define KERNEL_TARGET(arch)
+#endif
+
+namespace PixelKernels
+{
+namespace
+{
+QAtomicInt g_featureMask(-1);
+
+int detectFeatures()
+{
+    int features = 0;
+
+#if defined(Q_PROCESSOR_X86) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1"))
+        features |= SSE41;
+    if (__builtin_cpu_supports("avx2"))
+        features |= AVX2;
+#elif defined(Q_PROCESSOR_X86) && defined(Q_CC_MSVC)
+    int info[4];
+    __cpuid(info, 1);
+    if (info[2] & (1 << 19))
+        features |= SSE41;
+
+    // AVX2 还需要操作系统保存 YMM 寄存器
+    bool osxsave = info[2] & (1 << 27);
+    __cpuidex(info, 7, 0);
+    if (osxsave && (info[1] & (1 << 5)) && (_xgetbv(0) & 0x6) == 0x6)
+        features |= AVX2;
+#endif
+
+    return features;
+}
+
+inline int clamp8(int value)
+{
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+inline int weightPair(qint16 w0, qint16 w1)
+{
+    return int(quint32(quint16(w0)) | (quint32(quint16(w1)) << 16));
+}
+
+void horizontalScalar(const quint32 *src, quint32 *dst, int dstWidth,
+                      const int *bounds, const qint16 *weights, int taps)
+{
+    for (int x = 0; x < dstWidth; ++x)
+    {
+        const uchar *p   = reinterpret_cast<const uchar*>(src + bounds[2 * x]);
+        const int count  = bounds[2 * x + 1];
+        const qint16 *w  = weights + x * taps;
+        int c0 = 1 << (WeightBits - 1), c1 = c0, c2 = c0, c3 = c0;
+
+        for (int k = 0; k < count; ++k, p += 4)
+        {
+            c0 += p[0] * w[k];
+            c1 += p[1] * w[k];
+            c2 += p[2] * w[k];
+            c3 += p[3] * w[k];
+        }
+
+        uchar *out = reinterpret_cast<uchar*>(dst + x);
+        out[0] = uchar(clamp8(c0 >> WeightBits));
+        out[1] = uchar(clamp8(c1 >> WeightBits));
+        out[2] = uchar(clamp8(c2 >> WeightBits));
+        out[3] = uchar(clamp8(c3 >> WeightBits));
+    }
+}
+
+void verticalScalar(const uchar *src, int srcStride, quint32 *dst, int width,
+                    int count, const qint16 *weights, int from)
+{
+    uchar *out = reinterpret_cast<uchar*>(dst);
+
+    for (int i = from * 4; i < width * 4; ++i)
+    {
+        int c = 1 << (WeightBits - 1);
+        for (int k = 0; k < count; ++k)
+            c += src[k * srcStride + i] * weights[k];
+
+        out[i] = uchar(clamp8(c >> WeightBits));
+    }
+}
+
+void blendScalar(const quint32 *a, const quint32 *b, quint32 *dst, int count, int alpha)
+{
+    // 每个 32 位数中同时计算两个通道，乘积不超过 0xff00，不会溢出到相邻通道
+    const quint32 inverse = quint32(256 - alpha);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const quint32 rb = (((a[i] & 0x00ff00ff) * inverse + (b[i] & 0x00ff00ff) * quint32(alpha)) >> 8) & 0x00ff00ff;
+        const quint32 ag = (((a[i] >> 8) & 0x00ff00ff) * inverse + ((b[i] >> 8) & 0x00ff00ff) * quint32(alpha)) & 0xff00ff00;
+
+        dst[i] = rb | ag;
+    }
+}
+
+void expandPaletteScalar(const uchar *indices, const quint32 *palette, quint32 *dst, int count)
+{
+    int i = 0;
+
+    for (; i + 3 < count; i += 4)
+    {
+        dst[i]     = palette[indices[i]];
+        dst[i + 1] = palette[indices[i + 1]];
+        dst[i + 2] = palette[indices[i + 2]];
+        dst[i + 3] = palette[indices[i + 3]];
+    }
+
+    for (; i < count; ++i)
+        dst[i] = palette[indices[i]];
+}
+
+#if defined(Q_PROCESSOR_X86)
+// 两个相邻像素按通道交错展开为 16 位，配合 madd 一次完成两个采样点的乘加
+KERNEL_TARGET("sse4.1")
+inline __m128i horizontalTail(const quint32 *p, const qint16 *w, int k, int count, __m128i acc)
+{
+    const __m128i shuffle2 = _mm_setr_epi8(0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1);
+    const __m128i shuffle1 = _mm_setr_epi8(0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3, -1, -1, -1);
+
+    for (; k + 1 < count; k += 2)
+    {
+        __m128i pix = _mm_shuffle_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k)), shuffle2);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(pix, _mm_set1_epi32(weightPair(w[k], w[k + 1]))));
+    }
+
+    if (k < count)
+    {
+        __m128i pix = _mm_shuffle_epi8(_mm_cvtsi32_si128(int(p[k])), shuffle1);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(pix, _mm_set1_epi32(weightPair(w[k], 0))));
+    }
+
+    return acc;
+}
+
+KERNEL_TARGET("sse4.1")
+inline quint32 packPixel(__m128i acc)
+{
+    acc = _mm_srai_epi32(acc, WeightBits);
+    acc = _mm_packs_epi32(acc, acc);
+    acc = _mm_packus_epi16(acc, acc);
+
+    return quint32(_mm_cvtsi128_si32(acc));
+}
+
+KERNEL_TARGET("sse4.1")
+void horizontalSse41(const quint32 *src, quint32 *dst, int dstWidth,
+                     const int *bounds, const qint16 *weights, int taps)
+{
+    for (int x = 0; x < dstWidth; ++x)
+    {
+        __m128i acc = _mm_set1_epi32(1 << (WeightBits - 1));
+        acc = horizontalTail(src + bounds[2 * x], weights + x * taps, 0, bounds[2 * x + 1], acc);
+        dst[x] = packPixel(acc);
+    }
+}
+
+KERNEL_TARGET("avx2")
+void horizontalAvx2(const quint32 *src, quint32 *dst, int dstWidth,
+                    const int *bounds, const qint16 *weights, int taps)
+{
+    // 每次处理四个采样点：低 128 位处理前两个，高 128 位处理后两个
+    const __m256i shuffle4 = _mm256_setr_epi8(0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1,
+                                              8, -1, 12, -1, 9, -1, 13, -1, 10, -1, 14, -1, 11, -1, 15, -1);
+
+    for (int x = 0; x < dstWidth; ++x)
+    {
+        const quint32 *p = src + bounds[2 * x];
+        const int count  = bounds[2 * x + 1];
+        const qint16 *w  = weights + x * taps;
+        __m256i acc256   = _mm256_setzero_si256();
+        int k = 0;
+
+        for (; k + 3 < count; k += 4)
+        {
+            __m128i four = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k));
+            __m256i pix  = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(four), shuffle4);
+            __m256i wt   = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi32(weightPair(w[k], w[k + 1]))),
+                                                   _mm_set1_epi32(weightPair(w[k + 2], w[k + 3])), 1);
+            acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(pix, wt));
+        }
+
+        __m128i acc = _mm_add_epi32(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+        acc = _mm_add_epi32(acc, _mm_set1_epi32(1 << (WeightBits - 1)));
+        acc = horizontalTail(p, w, k, count, acc);
+        dst[x] = packPixel(acc);
+    }
+}
+
+// 两行对应字节交错后展开为 16 位，madd 一次完成两行的乘加
+KERNEL_TARGET("sse4.1")
+void verticalSse41(const uchar *src, int srcStride, quint32 *dst, int width,
+                   int count, const qint16 *weights)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (WeightBits - 1));
+    int x = 0;
+
+    for (; x + 3 < width; x += 4)
+    {
+        __m128i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+        const uchar *p = src + x * 4;
+        int k = 0;
+
+        for (; k < count; k += 2)
+        {
+            __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k * srcStride));
+            __m128i r1 = k + 1 < count ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + (k + 1) * srcStride)) : zero;
+            __m128i wt = _mm_set1_epi32(weightPair(weights[k], k + 1 < count ? weights[k + 1] : 0));
+
+            __m128i lo = _mm_unpacklo_epi8(r0, r1);
+            __m128i hi = _mm_unpackhi_epi8(r0, r1);
+            acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), wt));
+            acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), wt));
+            acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), wt));
+            acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), wt));
+        }
+
+        __m128i lo = _mm_packs_epi32(_mm_srai_epi32(acc0, WeightBits), _mm_srai_epi32(acc1, WeightBits));
+        __m128i hi = _mm_packs_epi32(_mm_srai_epi32(acc2, WeightBits), _mm_srai_epi32(acc3, WeightBits));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+    }
+
+    verticalScalar(src, srcStride, dst, width, count, weights, x);
+}
+
+KERNEL_TARGET("avx2")
+void verticalAvx2(const uchar *src, int srcStride, quint32 *dst, int width,
+                  int count, const qint16 *weights)
+{
+    // unpack 与 pack 都在 128 位通道内进行，两次交错后字节顺序恢复原样
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi32(1 << (WeightBits - 1));
+    int x = 0;
+
+    for (; x + 7 < width; x += 8)
+    {
+        __m256i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+        const uchar *p = src + x * 4;
+        int k = 0;
+
+        for (; k < count; k += 2)
+        {
+            __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + k * srcStride));
+            __m256i r1 = k + 1 < count ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + (k + 1) * srcStride)) : zero;
+            __m256i wt = _mm256_set1_epi32(weightPair(weights[k], k + 1 < count ? weights[k + 1] : 0));
+
+            __m256i lo = _mm256_unpacklo_epi8(r0, r1);
+            __m256i hi = _mm256_unpackhi_epi8(r0, r1);
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), wt));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), wt));
+            acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), wt));
+            acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), wt));
+        }
+
+        __m256i lo = _mm256_packs_epi32(_mm256_srai_epi32(acc0, WeightBits), _mm256_srai_epi32(acc1, WeightBits));
+        __m256i hi = _mm256_packs_epi32(_mm256_srai_epi32(acc2, WeightBits), _mm256_srai_epi32(acc3, WeightBits));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_packus_epi16(lo, hi));
+    }
+
+    verticalSse41(src + x * 4, srcStride, dst + x, width - x, count, weights);
+}
+
+// 16 位无符号运算：255 * 256 = 0xff00，乘加结果不会溢出
+KERNEL_TARGET("sse4.1")
+void blendSse41(const quint32 *a, const quint32 *b, quint32 *dst, int count, int alpha)
+{
+    const __m128i zero    = _mm_setzero_si128();
+    const __m128i wa      = _mm_set1_epi16(short(256 - alpha));
+    const __m128i wb      = _mm_set1_epi16(short(alpha));
+    int i = 0;
+
+    for (; i + 3 < count; i += 4)
+    {
+        __m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pa, zero), wa), _mm_mullo_epi16(_mm_unpacklo_epi8(pb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pa, zero), wa), _mm_mullo_epi16(_mm_unpackhi_epi8(pb, zero), wb));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+
+    blendScalar(a + i, b + i, dst + i, count - i, alpha);
+}
+
+KERNEL_TARGET("avx2")
+void blendAvx2(const quint32 *a, const quint32 *b, quint32 *dst, int count, int alpha)
+{
+    const __m256i zero    = _mm256_setzero_si256();
+    const __m256i wa      = _mm256_set1_epi16(short(256 - alpha));
+    const __m256i wb      = _mm256_set1_epi16(short(alpha));
+    int i = 0;
+
+    for (; i + 7 < count; i += 8)
+    {
+        __m256i pa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i pb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(pa, zero), wa), _mm256_mullo_epi16(_mm256_unpacklo_epi8(pb, zero), wb));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(pa, zero), wa), _mm256_mullo_epi16(_mm256_unpackhi_epi8(pb, zero), wb));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8)));
+    }
+
+    blendSse41(a + i, b + i, dst + i, count - i, alpha);
+}
+
+// 8 个下标零扩展为 32 位后一次 gather 取出调色板颜色
+KERNEL_TARGET("avx2")
+void expandPaletteAvx2(const uchar *indices, const quint32 *palette, quint32 *dst, int count)
+{
+    const int *table = reinterpret_cast<const int*>(palette);
+    int i = 0;
+
+    for (; i + 15 < count; i += 16)
+    {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+        __m256i lo = _mm256_cvtepu8_epi32(packed);
+        __m256i hi = _mm256_cvtepu8_epi32(_mm_srli_si128(packed, 8));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_i32gather_epi32(table, lo, 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 8), _mm256_i32gather_epi32(table, hi, 4));
+    }
+
+    expandPaletteScalar(indices + i, palette, dst + i, count - i);
+}
+
+#endif
+}
+
+int cpuFeatures()
+{
+    static const int features = detectFeatures();
+    return features;
+}
+
+int enabledFeatures()
+{
+    return cpuFeatures() & g_featureMask.load();
+}
+
+void setFeatureMask(int mask)
+{
+    g_featureMask.store(mask);
+}
+
+void resampleHorizontal(const quint32 *src, quint32 *dst, int dstWidth,
+                        const int *bounds, const qint16 *weights, int taps)
+{
+#if defined(Q_PROCESSOR_X86)
+    const int features = enabledFeatures();
+
+    if (features & AVX2)
+        return horizontalAvx2(src, dst, dstWidth, bounds, weights, taps);
+    if (features & SSE41)
+        return horizontalSse41(src, dst, dstWidth, bounds, weights, taps);
+#endif
+
+    horizontalScalar(src, dst, dstWidth, bounds, weights, taps);
+}
+
+void resampleVertical(const uchar *src, int srcStride, quint32 *dst, int width,
+                      int count, const qint16 *weights)
+{
+#if defined(Q_PROCESSOR_X86)
+    const int features = enabledFeatures();
+
+    if (features & AVX2)
+        return verticalAvx2(src, srcStride, dst, width, count, weights);
+    if (features & SSE41)
+        return verticalSse41(src, srcStride, dst, width, count, weights);
+#endif
+
+    verticalScalar(src, srcStride, dst, width, count, weights, 0);
+}
+
+void blend(const quint32 *a, const quint32 *b, quint32 *dst, int count, int alpha)
+{
+#if defined(Q_PROCESSOR_X86)
+    const int features = enabledFeatures();
+
+    if (features & AVX2)
+        return blendAvx2(a, b, dst, count, alpha);
+    if (features & SSE41)
+        return blendSse41(a, b, dst, count, alpha);
+#endif
+
+    blendScalar(a, b, dst, count, alpha);
+}
+
+void expandPalette(const uchar *indices, const quint32 *palette, quint32 *dst, int count)
+{
+#if defined(Q_PROCESSOR_X86)
+    if (enabledFeatures() & AVX2)
+        return expandPaletteAvx2(indices, palette, dst, count);
+#endif
+
+    expandPaletteScalar(indices, palette, dst, count);
+}
+
+void sampleLinear(const quint32 *src, quint32 *dst, int count, quint32 x, quint32 dx)
+{
+    // 权重取 8 位，与 blend 相同的双通道技巧
+    for (int i = 0; i < count; ++i, x += dx)
+    {
+        const quint32 *p = src + (x >> 16);
+        const quint32 w = (x >> 8) & 0xff;
+        const quint32 inverse = 256 - w;
+
+        const quint32 rb = (((p[0] & 0x00ff00ff) * inverse + (p[1] & 0x00ff00ff) * w) >> 8) & 0x00ff00ff;
+        const quint32 ag = (((p[0] >> 8) & 0x00ff00ff) * inverse + ((p[1] >> 8) & 0x00ff00ff) * w) & 0xff00ff00;
+
+        dst[i] = rb | ag;
+    }
+}
+
+void clampPremultiplied(quint32 *pixels, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const quint32 p = pixels[i];
+        const quint32 a = p >> 24;
+        const quint32 r = qMin((p >> 16) & 0xff, a);
+        const quint32 g = qMin((p >> 8) & 0xff, a);
+        const quint32 b = qMin(p & 0xff, a);
+
+        pixels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+}
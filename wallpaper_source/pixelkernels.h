@@ -0,0 +1,43 @@
+#ifndef PIXELKERNELS_H
+#define PIXELKERNELS_H
+
+#include <QtGlobal>
+
+// 像素处理内核：运行时按 CPU 指令集选择 AVX2 / SSE4.1 实现，其余平台使用标量实现
+namespace PixelKernels
+{
+enum Feature
+{
+    SSE41 = 0x1,
+    AVX2  = 0x2
+};
+
+// 重采样权重为 14 位定点数，每个输出像素的权重之和为 1 << WeightBits
+const int WeightBits = 14;
+
+int cpuFeatures();
+int enabledFeatures();
+void setFeatureMask(int mask);
+
+// 水平方向：bounds 为每个输出像素的 [起始下标, 采样数]，weights 按 taps 对齐存放
+void resampleHorizontal(const quint32 *src, quint32 *dst, int dstWidth,
+                        const int *bounds, const qint16 *weights, int taps);
+
+// 垂直方向：src 指向第一个参与计算的行，共 count 行
+void resampleVertical(const uchar *src, int srcStride, quint32 *dst, int width,
+                      int count, const qint16 *weights);
+
+// 预乘格式经过带负瓣的滤波后颜色分量可能大于透明度，需要截断
+void clampPremultiplied(quint32 *pixels, int count);
+
+// 逐通道线性混合 dst = (a * (256 - alpha) + b * alpha) / 256，alpha 取值 0 ~ 256
+void blend(const quint32 *a, const quint32 *b, quint32 *dst, int count, int alpha);
+
+// 调色板展开 dst[i] = palette[indices[i]]，palette 必须有 256 项
+void expandPalette(const uchar *indices, const quint32 *palette, quint32 *dst, int count);
+
+// 水平线性插值采样：x 与 dx 为 16.16 定点数，调用方保证 src 在 x + (count - 1) * dx 之后还有一个像素
+void sampleLinear(const quint32 *src, quint32 *dst, int count, quint32 x, quint32 dx);
+}
+
+#endif // PIXELKERNELS_H
@@ -0,0 +1,334 @@
+#include "playlist.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+// 索引文件头，之后是每个条目在文本中的起始偏移
+struct IndexHeader
+{
+    char magic[4];
+    quint32 version;
+    quint64 count;
+    qint64 textSize;                            // 与文本文件的大小和修改时间一致时索引才有效
+    qint64 textModified;
+};
+
+static_assert(sizeof(IndexHeader) == 32, "IndexHeader must stay 32 bytes");
+
+const char IndexMagic[4] = { 'S', 'W', 'P', 'L' };
+const quint32 IndexVersion = 1;
+
+bool isEntry(const uchar *line, qint64 length)
+{
+    // 空行和 m3u 的注释行不是条目
+    return length > 0 && line[0] != '#' && !(length == 1 && line[0] == '\r');
+}
+}
+
+Playlist::Playlist()
+{ }
+
+Playlist::~Playlist()
+{
+    close();
+}
+
+QString Playlist::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/playlist.m3u");
+}
+
+bool Playlist::open(const QString &path)
+{
+    close();
+
+    m_path = path;
+    m_text.setFileName(path);
+
+    if (!m_text.exists())
+        return true;
+
+    if (!m_text.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_text.size();
+    m_data = m_size > 0 ? m_text.map(0, m_size) : nullptr;
+
+    if (m_size > 0 && m_data == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    // 索引与文本不匹配时重新扫描一遍文本并重写索引，写入成功后改为映射新索引
+    const qint64 modified = QFileInfo(m_text).lastModified().toMSecsSinceEpoch();
+    if (!loadIndex(modified))
+    {
+        buildIndex();
+        if (writeIndex(modified) && loadIndex(modified))
+            m_offsets.clear();
+    }
+
+    return true;
+}
+
+void Playlist::close()
+{
+    if (m_data != nullptr)
+        m_text.unmap(const_cast<uchar*>(m_data));
+    if (m_mapped != nullptr)
+        m_index.unmap(reinterpret_cast<uchar*>(const_cast<quint64*>(m_mapped)));
+
+    m_text.close();
+    m_index.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = nullptr;
+    m_mappedCount = 0;
+    m_offsets.clear();
+}
+
+QString Playlist::path() const
+{
+    return m_path;
+}
+
+int Playlist::count() const
+{
+    return m_mappedCount + m_offsets.count();
+}
+
+bool Playlist::isEmpty() const
+{
+    return count() == 0;
+}
+
+QString Playlist::at(int index) const
+{
+    if (index < 0 || index >= count())
+        return QString();
+
+    const quint64 begin = offset(index);
+    const uchar *line = m_data + begin;
+    const uchar *end  = static_cast<const uchar*>(memchr(line, '\n', size_t(m_size - qint64(begin))));
+    qint64 length = (end != nullptr ? end : m_data + m_size) - line;
+
+    if (length > 0 && line[length - 1] == '\r')
+        --length;
+
+    return QString::fromUtf8(reinterpret_cast<const char*>(line), int(length));
+}
+
+int Playlist::duration(int index) const
+{
+    if (index < 0 || index >= count())
+        return 0;
+
+    // 条目的上一行是 m3u 的 #EXTINF:<秒数>,<标题> 时按其中的秒数显示，没有或为负数时使用默认时长
+    const quint64 begin = offset(index);
+    if (begin == 0)
+        return 0;
+
+    qint64 end = qint64(begin) - 1;
+    if (end > 0 && m_data[end - 1] == '\r')
+        --end;
+
+    qint64 start = end;
+    while (start > 0 && m_data[start - 1] != '\n')
+        --start;
+
+    static const char Tag[] = "#EXTINF:";
+    const qint64 tagLength = qint64(sizeof(Tag)) - 1;
+
+    if (end - start <= tagLength || memcmp(m_data + start, Tag, size_t(tagLength)) != 0)
+        return 0;
+
+    const QByteArray line = QByteArray::fromRawData(reinterpret_cast<const char*>(m_data + start + tagLength),
+                                                    int(end - start - tagLength));
+    const int comma = line.indexOf(',');
+
+    bool ok = false;
+    const double seconds = (comma >= 0 ? line.left(comma) : line).trimmed().toDouble(&ok);
+
+    return ok && seconds > 0 ? int(qMin(seconds * 1000.0, double(std::numeric_limits<int>::max()))) : 0;
+}
+
+QStringList Playlist::toStringList() const
+{
+    QStringList entries;
+    entries.reserve(count());
+
+    for (int i = 0; i < count(); ++i)
+        entries.append(at(i));
+
+    return entries;
+}
+
+bool Playlist::append(const QStringList &entries)
+{
+    if (entries.isEmpty())
+        return true;
+
+    if (m_path.isEmpty())
+        m_path = defaultPath();
+
+    // 文本末尾没有换行时先补上，新条目只追加到文件末尾，已有内容和索引都不重写
+    const bool needsNewline = m_size > 0 && m_data[m_size - 1] != '\n';
+    const bool indexValid   = m_index.isOpen();
+    const int oldCount      = count();
+    const QString path      = m_path;
+
+    QVector<quint64> offsets;
+    QByteArray data;
+
+    if (needsNewline)
+        data.append('\n');
+
+    for (const QString &entry : entries)
+    {
+        offsets.append(quint64(m_size + data.size()));
+        data.append(entry.toUtf8());
+        data.append('\n');
+    }
+
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(data) != data.size())
+    {
+        open(path);
+        return false;
+    }
+    file.close();
+
+    if (!indexValid)
+        return open(path);
+
+    // 重新映射前只把新增的偏移追加到索引末尾并更新文件头
+    QFile index(indexPath());
+    if (index.open(QIODevice::ReadWrite))
+    {
+        IndexHeader header;
+        if (index.read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header))
+        {
+            header.count        = quint64(oldCount + offsets.count());
+            header.textSize     = QFileInfo(path).size();
+            header.textModified = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+
+            index.seek(index.size());
+            index.write(reinterpret_cast<const char*>(offsets.constData()), qint64(offsets.count()) * sizeof(quint64));
+            index.seek(0);
+            index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+        index.close();
+    }
+
+    return open(path);
+}
+
+bool Playlist::setEntries(const QStringList &entries)
+{
+    const QString path = m_path.isEmpty() ? defaultPath() : m_path;
+
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    for (const QString &entry : entries)
+    {
+        file.write(entry.toUtf8());
+        file.write("\n", 1);
+    }
+
+    if (!file.commit())
+        return false;
+
+    return open(path);
+}
+
+QString Playlist::indexPath() const
+{
+    return m_path + QStringLiteral(".idx");
+}
+
+bool Playlist::loadIndex(qint64 modified)
+{
+    m_index.setFileName(indexPath());
+    if (!m_index.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = m_index.size();
+    const uchar *data = size >= qint64(sizeof(IndexHeader)) ? m_index.map(0, size) : nullptr;
+    const IndexHeader *header = reinterpret_cast<const IndexHeader*>(data);
+
+    if (data == nullptr || memcmp(header->magic, IndexMagic, sizeof(IndexMagic)) != 0 || header->version != IndexVersion
+            || header->textSize != m_size || header->textModified != modified
+            || size != qint64(sizeof(IndexHeader) + header->count * sizeof(quint64)))
+    {
+        if (data != nullptr)
+            m_index.unmap(const_cast<uchar*>(data));
+        m_index.close();
+        return false;
+    }
+
+    m_mapped      = reinterpret_cast<const quint64*>(data + sizeof(IndexHeader));
+    m_mappedCount = int(header->count);
+
+    return true;
+}
+
+void Playlist::buildIndex()
+{
+    m_offsets.clear();
+
+    const uchar *line = m_data;
+    const uchar *end  = m_data + m_size;
+
+    while (line < end)
+    {
+        const uchar *next = static_cast<const uchar*>(memchr(line, '\n', size_t(end - line)));
+        const uchar *lineEnd = next != nullptr ? next : end;
+
+        if (isEntry(line, lineEnd - line))
+            m_offsets.append(quint64(line - m_data));
+
+        line = lineEnd + 1;
+    }
+}
+
+bool Playlist::writeIndex(qint64 modified)
+{
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+    header.version      = IndexVersion;
+    header.count        = quint64(m_offsets.count());
+    header.textSize     = m_size;
+    header.textModified = modified;
+
+    QSaveFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_offsets.constData()), qint64(m_offsets.count()) * sizeof(quint64));
+
+    return file.commit();
+}
+
+quint64 Playlist::offset(int index) const
+{
+    return index < m_mappedCount ? m_mapped[index] : m_offsets.at(index - m_mappedCount);
+}
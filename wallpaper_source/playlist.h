@@ -0,0 +1,49 @@
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 播放列表文件：每行一个路径的 UTF-8 文本（兼容 m3u），另存一份条目偏移索引；两者都内存映射，条目在访问时才解析
+class Playlist
+{
+public:
+    Playlist();
+    ~Playlist();
+
+    static QString defaultPath();
+
+    bool open(const QString &path);
+    void close();
+    QString path() const;
+
+    int count() const;
+    bool isEmpty() const;
+    QString at(int index) const;
+    int duration(int index) const;
+    QStringList toStringList() const;
+
+    bool append(const QStringList &entries);
+    bool setEntries(const QStringList &entries);
+
+private:
+    QString indexPath() const;
+    bool loadIndex(qint64 modified);
+    void buildIndex();
+    bool writeIndex(qint64 modified);
+    quint64 offset(int index) const;
+
+private:
+    QString m_path;
+    QFile m_text;
+    QFile m_index;
+    const uchar *m_data = nullptr;              // 映射的文本内容
+    qint64 m_size = 0;
+    const quint64 *m_mapped = nullptr;          // 映射的偏移索引
+    int m_mappedCount = 0;
+    QVector<quint64> m_offsets;                 // 索引失效时重新扫描得到的偏移
+};
+
+#endif // PLAYLIST_H
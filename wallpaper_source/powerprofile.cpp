@@ -0,0 +1,169 @@
+#include "powerprofile.h"
+
+#if defined(Q_OS_WIN)
+#  include <qt_windows.h>
+#elif defined(Q_OS_UNIX)
+#  include <sys/resource.h>
+#endif
+
+PowerProfile::PowerProfile(QObject *parent) : QObject(parent)
+{
+    // 供电状态没有统一的变化通知，30 秒查询一次足够及时
+    m_pollTimer.setInterval(30 * 1000);
+    m_sampleTimer.setInterval(60 * 1000);
+
+    connect(&m_pollTimer, &QTimer::timeout, this, &PowerProfile::update);
+    connect(&m_sampleTimer, &QTimer::timeout, this, &PowerProfile::onSample);
+
+    m_lastCpu = processCpuTime();
+    m_wallClock.start();
+    m_sampleTimer.start();
+
+    setSource(PowerSource::createDefault(this));
+}
+
+PowerProfile::~PowerProfile()
+{ }
+
+PowerProfile::Limits PowerProfile::limits(Profile profile)
+{
+    switch (profile)
+    {
+    case Balanced:
+        return { 30, 30, 30, 2, false, false, 1, 1 };
+    case Battery:
+        return { 15, 20, 15, 1, true, true, 0, 1 };
+    default:
+        return { 60, 60, 30, 0, false, false, 1, 2 };
+    }
+}
+
+QString PowerProfile::name(Profile profile)
+{
+    switch (profile)
+    {
+    case Balanced:
+        return QStringLiteral("balanced");
+    case Battery:
+        return QStringLiteral("battery");
+    default:
+        return QStringLiteral("performance");
+    }
+}
+
+qint64 PowerProfile::processCpuTime()
+{
+    // 本进程所有线程的用户态与内核态时间之和，毫秒
+#if defined(Q_OS_WIN)
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+
+    auto toMsec = [](const FILETIME &time){
+        return ((qint64(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10000;
+    };
+
+    return toMsec(kernel) + toMsec(user);
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    return (qint64(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000
+            + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#else
+    return 0;
+#endif
+}
+
+void PowerProfile::setSource(PowerSource *source)
+{
+    if (m_pSource != nullptr && m_pSource->parent() == this)
+        delete m_pSource;
+
+    m_pSource = source;
+
+    if (m_pSource != nullptr)
+    {
+        connect(m_pSource, &PowerSource::changed, this, &PowerProfile::update);
+        m_pollTimer.start();
+    }
+    else
+    {
+        m_pollTimer.stop();
+    }
+
+    update();
+}
+
+PowerSource *PowerProfile::source() const
+{
+    return m_pSource;
+}
+
+void PowerProfile::setMode(int mode)
+{
+    m_mode = mode >= 0 && mode < ProfileCount ? mode : int(Automatic);
+    update();
+}
+
+int PowerProfile::mode() const
+{
+    return m_mode;
+}
+
+PowerProfile::Profile PowerProfile::profile() const
+{
+    return m_profile;
+}
+
+PowerProfile::Limits PowerProfile::limits() const
+{
+    return limits(m_profile);
+}
+
+double PowerProfile::cpuPerMinute(Profile profile) const
+{
+    if (profile < 0 || profile >= ProfileCount || m_wall[profile] == 0)
+        return -1;
+
+    return m_cpu[profile] * 60000.0 / m_wall[profile];
+}
+
+void PowerProfile::update()
+{
+    const Profile profile = m_mode == Automatic ? automaticProfile() : Profile(m_mode);
+    if (profile == m_profile)
+        return;
+
+    // 切换前的时间计入旧模式
+    onSample();
+
+    m_profile = profile;
+    emit profileChanged(m_profile);
+}
+
+void PowerProfile::onSample()
+{
+    const qint64 now  = processCpuTime();
+    const qint64 cpu  = now - m_lastCpu;
+    const qint64 wall = m_wallClock.restart();
+
+    m_cpu[m_profile]  += cpu;
+    m_wall[m_profile] += wall;
+    m_lastCpu = now;
+
+    // 不足一秒的片段（例如连续切换）只累计不上报
+    if (wall >= 1000)
+        emit cpuSampled(m_profile, cpu * 60000.0 / wall);
+}
+
+PowerProfile::Profile PowerProfile::automaticProfile() const
+{
+    // 外接供电全速运行，电池供电时电量过半或未知为均衡，否则节能
+    if (m_pSource == nullptr || !m_pSource->onBattery())
+        return Performance;
+
+    const int level = m_pSource->batteryLevel();
+    return level >= 50 || level < 0 ? Balanced : Battery;
+}
@@ -0,0 +1,86 @@
+#ifndef POWERPROFILE_H
+#define POWERPROFILE_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include "powersource.h"
+
+// 电源模式：按供电状态自动选择或手动指定，统一限制动画帧率、视频解码开销和预取深度，并统计各模式下每分钟的处理器时间
+class PowerProfile : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Profile
+    {
+        Performance = 0,
+        Balanced,
+        Battery,
+        ProfileCount
+    };
+
+    enum Mode
+    {
+        Automatic = -1                          // 其余取值与 Profile 相同
+    };
+
+    struct Limits
+    {
+        int animationFps;                       // GIF 等动画壁纸的呈现帧率上限
+        int transitionFps;
+        int kenBurnsFps;
+        int videoThreads;                       // avcodec-threads，0 为自动
+        bool videoSkipLoopFilter;               // 跳过 H.264 去块滤波
+        bool videoSkipIdct;                     // 跳过非参考帧的反变换，降低画质换取解码开销
+        int lookbehind;                         // 轮播预取窗口
+        int lookahead;
+    };
+
+    explicit PowerProfile(QObject *parent = nullptr);
+    ~PowerProfile();
+
+    static Limits limits(Profile profile);
+    static QString name(Profile profile);
+    static qint64 processCpuTime();
+
+    void setSource(PowerSource *source);
+    PowerSource *source() const;
+
+    void setMode(int mode);
+    int mode() const;
+
+    Profile profile() const;
+    Limits limits() const;
+
+    double cpuPerMinute(Profile profile) const;
+
+signals:
+    void profileChanged(PowerProfile::Profile profile);
+    void cpuSampled(PowerProfile::Profile profile, double msecPerMinute);
+
+public slots:
+    void update();
+
+private slots:
+    void onSample();
+
+private:
+    Profile automaticProfile() const;
+
+private:
+    PowerSource *m_pSource = nullptr;
+    int m_mode = Automatic;
+    Profile m_profile = Performance;
+    QTimer m_pollTimer;
+
+    // 每个模式累计的处理器时间与经过时间，毫秒
+    QTimer m_sampleTimer;
+    QElapsedTimer m_wallClock;
+    qint64 m_lastCpu = 0;
+    qint64 m_cpu[ProfileCount] = { 0, 0, 0 };
+    qint64 m_wall[ProfileCount] = { 0, 0, 0 };
+};
+
+#endif // POWERPROFILE_H
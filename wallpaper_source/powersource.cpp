@@ -0,0 +1,123 @@
+#include "powersource.h"
+
+#include <QDir>
+#include <QFile>
+
+#if defined(Q_OS_WIN)
+#  include <qt_windows.h>
+#endif
+
+namespace
+{
+QByteArray readAttribute(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    return file.readAll().trimmed();
+}
+}
+
+PowerSource::PowerSource(QObject *parent) : QObject(parent)
+{ }
+
+PowerSource::~PowerSource()
+{ }
+
+PowerSource *PowerSource::createDefault(QObject *parent)
+{
+#if defined(Q_OS_WIN)
+    return new Win32PowerSource(parent);
+#else
+    return new SysfsPowerSource(QStringLiteral("/sys/class/power_supply"), parent);
+#endif
+}
+
+SysfsPowerSource::SysfsPowerSource(const QString &root, QObject *parent)
+    : PowerSource(parent), m_root(root)
+{ }
+
+bool SysfsPowerSource::onBattery()
+{
+    bool hasBattery = false;
+    bool discharging = false;
+
+    for (auto &name : QDir(m_root).entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        const QString dir = m_root + QLatin1Char('/') + name + QLatin1Char('/');
+        const QByteArray type = readAttribute(dir + QStringLiteral("type"));
+
+        // 任意一个外接电源在线即为外接供电
+        if (type == "Mains" || type == "USB")
+        {
+            if (readAttribute(dir + QStringLiteral("online")) == "1")
+                return false;
+        }
+        else if (type == "Battery" && readAttribute(dir + QStringLiteral("scope")) != "Device")
+        {
+            // scope 为 Device 的是鼠标、键盘等外设的电池
+            hasBattery = true;
+            discharging |= readAttribute(dir + QStringLiteral("status")) == "Discharging";
+        }
+    }
+
+    return hasBattery && discharging;
+}
+
+int SysfsPowerSource::batteryLevel()
+{
+    for (auto &name : QDir(m_root).entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        const QString dir = m_root + QLatin1Char('/') + name + QLatin1Char('/');
+        if (readAttribute(dir + QStringLiteral("type")) != "Battery" || readAttribute(dir + QStringLiteral("scope")) == "Device")
+            continue;
+
+        bool ok = false;
+        const int level = readAttribute(dir + QStringLiteral("capacity")).toInt(&ok);
+        if (ok)
+            return qBound(0, level, 100);
+    }
+
+    return -1;
+}
+
+#if defined(Q_OS_WIN)
+Win32PowerSource::Win32PowerSource(QObject *parent) : PowerSource(parent)
+{ }
+
+bool Win32PowerSource::onBattery()
+{
+    SYSTEM_POWER_STATUS status;
+    return GetSystemPowerStatus(&status) && status.ACLineStatus == 0;
+}
+
+int Win32PowerSource::batteryLevel()
+{
+    SYSTEM_POWER_STATUS status;
+    if (!GetSystemPowerStatus(&status) || status.BatteryLifePercent > 100)
+        return -1;
+
+    return status.BatteryLifePercent;
+}
+#endif
+
+FakePowerSource::FakePowerSource(QObject *parent) : PowerSource(parent)
+{ }
+
+bool FakePowerSource::onBattery()
+{
+    return m_onBattery;
+}
+
+int FakePowerSource::batteryLevel()
+{
+    return m_level;
+}
+
+void FakePowerSource::setOnBattery(bool onBattery, int level)
+{
+    m_onBattery = onBattery;
+    m_level = level;
+    emit changed();
+}
@@ -0,0 +1,72 @@
+#ifndef POWERSOURCE_H
+#define POWERSOURCE_H
+
+#include <QObject>
+#include <QString>
+
+// 供电状态查询接口，电量未知时 batteryLevel() 返回 -1
+class PowerSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PowerSource(QObject *parent = nullptr);
+    ~PowerSource();
+
+    static PowerSource *createDefault(QObject *parent = nullptr);
+
+    virtual bool onBattery() = 0;
+    virtual int batteryLevel() = 0;
+
+signals:
+    void changed();
+};
+
+// 读取 /sys/class/power_supply：有在线的外接电源或没有电池时视为外接供电
+class SysfsPowerSource : public PowerSource
+{
+    Q_OBJECT
+
+public:
+    explicit SysfsPowerSource(const QString &root = QStringLiteral("/sys/class/power_supply"), QObject *parent = nullptr);
+
+    bool onBattery() override;
+    int batteryLevel() override;
+
+private:
+    QString m_root;
+};
+
+#if defined(Q_OS_WIN)
+// GetSystemPowerStatus，台式机没有电池时 ACLineStatus 为 1
+class Win32PowerSource : public PowerSource
+{
+    Q_OBJECT
+
+public:
+    explicit Win32PowerSource(QObject *parent = nullptr);
+
+    bool onBattery() override;
+    int batteryLevel() override;
+};
+#endif
+
+// 手动设置供电状态，用于调试和测试
+class FakePowerSource : public PowerSource
+{
+    Q_OBJECT
+
+public:
+    explicit FakePowerSource(QObject *parent = nullptr);
+
+    bool onBattery() override;
+    int batteryLevel() override;
+
+    void setOnBattery(bool onBattery, int level = -1);
+
+private:
+    bool m_onBattery = false;
+    int m_level = -1;
+};
+
+#endif // POWERSOURCE_H
@@ -0,0 +1,88 @@
+#include "resolutionvariants.h"
+
+#include <QImageReader>
+#include <QRegularExpression>
+
+namespace
+{
+const QRegularExpression &resolutionDirPattern()
+{
+    static const QRegularExpression pattern(QStringLiteral("^\\d{3,5}x\\d{3,5}$"));
+    return pattern;
+}
+
+const QRegularExpression &resolutionTokenPattern()
+{
+    static const QRegularExpression pattern(QStringLiteral("[ _.@-]?\\d{3,5}[xX]\\d{3,5}"));
+    return pattern;
+}
+}
+
+QString ResolutionVariants::key(const QString &path)
+{
+    // 播放列表可能有十万条，只做字符串处理，不访问文件系统
+    const int slash = qMax(path.lastIndexOf(QLatin1Char('/')), path.lastIndexOf(QLatin1Char('\\')));
+    const int dot   = path.lastIndexOf(QLatin1Char('.'));
+    const int end   = dot > slash ? dot : path.length();
+
+    QString dir  = path.left(qMax(0, slash));
+    QString name = path.mid(slash + 1, end - slash - 1);
+
+    // 按分辨率命名的目录归到上一级，相邻目录中的同名文件即为同一组
+    const int parent = qMax(dir.lastIndexOf(QLatin1Char('/')), dir.lastIndexOf(QLatin1Char('\\')));
+    if (resolutionDirPattern().match(dir.mid(parent + 1)).hasMatch())
+        dir.truncate(qMax(0, parent));
+
+    const int length = name.length();
+    name.remove(resolutionTokenPattern());
+    if (name.isEmpty())
+        name = path.mid(slash + 1, length);
+
+    // 扩展名保留在键中，同名的 GIF 和 JPG 不会被当作同一张壁纸
+    return dir + QLatin1Char('/') + name.toLower() + path.mid(end).toLower();
+}
+
+QSize ResolutionVariants::imageSize(const QString &path)
+{
+    // 只读取文件头，不解码像素；旋转 90 度的图片按显示方向返回
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+
+    QSize size = reader.size();
+    if (size.isValid() && (reader.transformation() & QImageIOHandler::TransformationRotate90))
+        size.transpose();
+
+    return size;
+}
+
+QString ResolutionVariants::select(const QStringList &variants, const QSize &targetSize)
+{
+    // 选取不小于目标尺寸的最小版本；都比目标小时选最大的版本，缩放损失最小
+    QString best;
+    qint64 bestArea = -1;
+    bool bestCovers = false;
+
+    for (auto &path : variants)
+    {
+        const QSize size = imageSize(path);
+        if (!size.isValid())
+            continue;
+
+        const qint64 area = qint64(size.width()) * size.height();
+        const bool covers = targetSize.isValid() && size.width() >= targetSize.width() && size.height() >= targetSize.height();
+
+        const bool better = best.isEmpty()
+                || (covers && !bestCovers)
+                || (covers && bestCovers && area < bestArea)
+                || (!covers && !bestCovers && area > bestArea);
+
+        if (better)
+        {
+            best       = path;
+            bestArea   = area;
+            bestCovers = covers;
+        }
+    }
+
+    return best.isEmpty() ? variants.value(0) : best;
+}
@@ -0,0 +1,18 @@
+#ifndef RESOLUTIONVARIANTS_H
+#define RESOLUTIONVARIANTS_H
+
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+// 同一张壁纸的多种分辨率：文件名去掉分辨率标记后相同，且位于同一目录或按分辨率命名的相邻目录中（例如 image/1920x1080 与 image/3840x2160）
+class ResolutionVariants
+{
+public:
+    static QString key(const QString &path);
+    static QSize imageSize(const QString &path);
+
+    static QString select(const QStringList &variants, const QSize &targetSize);
+};
+
+#endif // RESOLUTIONVARIANTS_H
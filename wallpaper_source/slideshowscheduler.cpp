@@ -0,0 +1,250 @@
+#include "slideshowscheduler.h"
+
+#include <limits>
+#include <random>
+
+SlideshowScheduler::SlideshowScheduler(QObject *parent) : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+
+    connect(&m_timer, &QTimer::timeout, this, &SlideshowScheduler::onTimeout);
+}
+
+SlideshowScheduler::~SlideshowScheduler()
+{ }
+
+void SlideshowScheduler::setCount(int count)
+{
+    if (count == m_count)
+        return;
+
+    m_count = qMax(0, count);
+    m_current = m_count > 0 ? qMin(m_current, m_count - 1) : 0;
+
+    for (auto it = m_durations.begin(); it != m_durations.end();)
+    {
+        if (it.key() < m_count)
+            ++it;
+        else
+            it = m_durations.erase(it);
+    }
+
+    buildOrder();
+}
+
+int SlideshowScheduler::count() const
+{
+    return m_count;
+}
+
+void SlideshowScheduler::setDefaultDuration(int msec)
+{
+    msec = qMax(1, msec);
+
+    // 当前条目使用默认时长时，截止时间按新旧时长之差平移，不重新开始计时
+    if (m_active && !m_durations.contains(m_current))
+    {
+        if (m_paused)
+            m_remaining = qMax<qint64>(0, m_remaining + msec - m_defaultDuration);
+        else
+            m_deadline += msec - m_defaultDuration;
+    }
+
+    m_defaultDuration = msec;
+
+    if (m_active && !m_paused)
+        schedule();
+}
+
+int SlideshowScheduler::defaultDuration() const
+{
+    return m_defaultDuration;
+}
+
+void SlideshowScheduler::setDuration(int index, int msec)
+{
+    if (msec > 0)
+        m_durations.insert(index, msec);
+    else
+        m_durations.remove(index);
+}
+
+int SlideshowScheduler::duration(int index) const
+{
+    return m_durations.value(index, m_defaultDuration);
+}
+
+void SlideshowScheduler::setShuffle(bool shuffle, quint32 seed)
+{
+    if (shuffle == m_shuffle && seed == m_seed)
+        return;
+
+    m_shuffle = shuffle;
+    m_seed = seed;
+    buildOrder();
+}
+
+bool SlideshowScheduler::isShuffle() const
+{
+    return m_shuffle;
+}
+
+quint32 SlideshowScheduler::seed() const
+{
+    return m_seed;
+}
+
+void SlideshowScheduler::setPrefetchLead(int msec)
+{
+    m_prefetchLead = qMax(0, msec);
+}
+
+void SlideshowScheduler::setDecodeEstimate(int msec)
+{
+    m_decodeEstimate = qMax(0, msec);
+}
+
+int SlideshowScheduler::prefetchLead() const
+{
+    // 预留两倍的解码耗时，吸收解码线程被预取任务占用时的排队时间
+    return qMax(m_prefetchLead, m_decodeEstimate * 2);
+}
+
+void SlideshowScheduler::setCurrent(int index)
+{
+    if (index >= 0 && index < m_count)
+        m_current = index;
+}
+
+int SlideshowScheduler::current() const
+{
+    return m_current;
+}
+
+int SlideshowScheduler::nextIndex() const
+{
+    if (m_count <= 0)
+        return -1;
+
+    return m_order.at((m_position.at(m_current) + 1) % m_count);
+}
+
+void SlideshowScheduler::start()
+{
+    m_clock.start();
+    m_deadline   = duration(m_current);
+    m_active     = true;
+    m_paused     = false;
+    m_prefetched = false;
+
+    schedule();
+}
+
+void SlideshowScheduler::stop()
+{
+    m_timer.stop();
+    m_active = false;
+    m_paused = false;
+}
+
+void SlideshowScheduler::pause()
+{
+    if (!m_active || m_paused)
+        return;
+
+    m_remaining = qMax<qint64>(0, m_deadline - m_clock.elapsed());
+    m_paused = true;
+    m_timer.stop();
+}
+
+void SlideshowScheduler::resume()
+{
+    if (!m_active || !m_paused)
+        return;
+
+    m_deadline = m_clock.elapsed() + m_remaining;
+    m_paused = false;
+
+    schedule();
+}
+
+bool SlideshowScheduler::isActive() const
+{
+    return m_active;
+}
+
+bool SlideshowScheduler::isPaused() const
+{
+    return m_paused;
+}
+
+qint64 SlideshowScheduler::remaining() const
+{
+    if (!m_active)
+        return 0;
+
+    return m_paused ? m_remaining : qMax<qint64>(0, m_deadline - m_clock.elapsed());
+}
+
+void SlideshowScheduler::onTimeout()
+{
+    if (!m_active || m_paused || m_count <= 0)
+        return;
+
+    const qint64 now = m_clock.elapsed();
+
+    if (!m_prefetched && now >= m_deadline - prefetchLead())
+    {
+        m_prefetched = true;
+        emit prefetch(nextIndex());
+    }
+
+    if (now >= m_deadline)
+    {
+        const int next = nextIndex();
+
+        // 下一次截止时间由本次截止时间累加，不以实际触发时刻为起点；系统休眠等长时间停顿后重新对齐，避免连续切换
+        m_current    = next;
+        m_deadline  += duration(next);
+        m_prefetched = false;
+
+        if (m_deadline <= now)
+            m_deadline = now + duration(next);
+
+        emit advance(next);
+    }
+
+    schedule();
+}
+
+void SlideshowScheduler::buildOrder()
+{
+    m_order.resize(m_count);
+    m_position.resize(m_count);
+
+    for (int i = 0; i < m_count; ++i)
+        m_order[i] = i;
+
+    // 固定种子的 Fisher-Yates 洗牌，不使用标准库的分布，保证各平台生成的顺序一致
+    if (m_shuffle)
+    {
+        std::mt19937 engine(m_seed);
+        for (int i = m_count - 1; i > 0; --i)
+            qSwap(m_order[i], m_order[int(engine() % quint32(i + 1))]);
+    }
+
+    for (int i = 0; i < m_count; ++i)
+        m_position[m_order.at(i)] = i;
+}
+
+void SlideshowScheduler::schedule()
+{
+    if (!m_active || m_paused)
+        return;
+
+    const qint64 now = m_clock.elapsed();
+    const qint64 target = m_prefetched ? m_deadline : m_deadline - prefetchLead();
+
+    m_timer.start(int(qBound<qint64>(0, target - now, std::numeric_limits<int>::max())));
+}
@@ -0,0 +1,80 @@
+#ifndef SLIDESHOWSCHEDULER_H
+#define SLIDESHOWSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+// 轮播调度：按绝对截止时间切换，切换时刻不随定时器误差累积漂移；在截止时间之前提前通知预取下一张
+class SlideshowScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SlideshowScheduler(QObject *parent = nullptr);
+    ~SlideshowScheduler();
+
+    void setCount(int count);
+    int count() const;
+
+    void setDefaultDuration(int msec);
+    int defaultDuration() const;
+    void setDuration(int index, int msec);
+    int duration(int index) const;
+
+    void setShuffle(bool shuffle, quint32 seed);
+    bool isShuffle() const;
+    quint32 seed() const;
+
+    void setPrefetchLead(int msec);
+    void setDecodeEstimate(int msec);
+    int prefetchLead() const;
+
+    void setCurrent(int index);
+    int current() const;
+    int nextIndex() const;
+
+    void start();
+    void stop();
+    void pause();
+    void resume();
+    bool isActive() const;
+    bool isPaused() const;
+    qint64 remaining() const;
+
+signals:
+    void prefetch(int index);
+    void advance(int index);
+
+private slots:
+    void onTimeout();
+
+private:
+    void buildOrder();
+    void schedule();
+
+private:
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_deadline = 0;                      // 下一次切换的时刻，相对 m_clock 的毫秒数
+    qint64 m_remaining = 0;                     // 暂停时剩余的时间
+    bool m_active = false;
+    bool m_paused = false;
+    bool m_prefetched = false;
+
+    int m_count = 0;
+    int m_current = 0;
+    int m_defaultDuration = 5000;
+    QHash<int, int> m_durations;                // 单独设置了显示时长的条目
+    int m_prefetchLead = 1000;
+    int m_decodeEstimate = 0;
+
+    bool m_shuffle = false;
+    quint32 m_seed = 0;
+    QVector<int> m_order;                       // 播放顺序 -> 条目索引
+    QVector<int> m_position;                    // 条目索引 -> 播放顺序
+};
+
+#endif // SLIDESHOWSCHEDULER_H
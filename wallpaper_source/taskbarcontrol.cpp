@@ -37,6 +37,30 @@ void TaskbarControl::setAccentState(ACCENT_STATE state, QColor color)
     m_color = color;
 }
 
+void TaskbarControl::setSuspended(bool suspended)
+{
+    if (suspended == m_suspended || !m_setWindowCompositionAttribute)
+        return;
+
+    // 锁屏期间任务栏不可见，不必每 10 毫秒刷新一次；解锁时立即补刷一次
+    m_suspended = suspended;
+
+    if (suspended)
+    {
+        m_timer.stop();
+    }
+    else
+    {
+        onUpdateWindowCompositionAttribute();
+        m_timer.start(10);
+    }
+}
+
+bool TaskbarControl::isSuspended() const
+{
+    return m_suspended;
+}
+
 void TaskbarControl::onUpdateWindowCompositionAttribute()
 {
     DWORD color = m_color.alpha()<<24|m_color.blue()<<16|m_color.green()<<8|m_color.red();
@@ -80,11 +80,13 @@ public:
 
     QColor color() const;
     ACCENT_STATE accentState() const;
+    bool isSuspended() const;
 
 public slots:
     void setAutoHide(bool hide = false);
     void setColor(const QColor &color);
     void setAccentState(ACCENT_STATE accentState);
+    void setSuspended(bool suspended);
 
 private slots:
     void onUpdateWindowCompositionAttribute();
@@ -93,6 +95,7 @@ private:
     QColor m_color = QColor(255, 255, 255, 0);
     ACCENT_STATE m_accentState = ACCENT_ENABLE_GRADIENT;
     QTimer m_timer;
+    bool m_suspended = false;
 
     HWND m_hTray;
     pfnSetWindowCompositionAttribute m_setWindowCompositionAttribute;
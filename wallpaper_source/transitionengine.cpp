@@ -0,0 +1,218 @@
+#include "transitionengine.h"
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <cstring>
+
+#include "pixelkernels.h"
+
+namespace
+{
+struct Band
+{
+    int begin;
+    int end;
+};
+
+qreal smoothStep(qreal t)
+{
+    return t * t * (3 - 2 * t);
+}
+}
+
+TransitionEngine::TransitionEngine(QObject *parent) : QObject(parent)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+
+    connect(&m_timer, &QTimer::timeout, this, &TransitionEngine::onTick);
+}
+
+TransitionEngine::~TransitionEngine()
+{
+    m_render.waitForFinished();
+}
+
+void TransitionEngine::setEffect(Effect effect)
+{
+    m_effect = effect;
+}
+
+TransitionEngine::Effect TransitionEngine::effect() const
+{
+    return m_effect;
+}
+
+void TransitionEngine::setDuration(int msec)
+{
+    m_duration = qMax(1, msec);
+}
+
+int TransitionEngine::duration() const
+{
+    return m_duration;
+}
+
+void TransitionEngine::setFrameRate(int fps)
+{
+    m_frameRate = qBound(1, fps, 240);
+
+    if (m_timer.isActive())
+        m_timer.setInterval(1000 / m_frameRate);
+}
+
+int TransitionEngine::frameRate() const
+{
+    return m_frameRate;
+}
+
+bool TransitionEngine::isRunning() const
+{
+    return m_timer.isActive();
+}
+
+TransitionEngine::Statistics TransitionEngine::statistics() const
+{
+    return m_statistics;
+}
+
+bool TransitionEngine::start(const QImage &from, const QImage &to)
+{
+    stop();
+
+    // 两张图片尺寸必须一致；RGB32 与预乘格式内存布局相同，可以直接逐像素混合
+    if (m_effect == NoEffect || from.isNull() || to.isNull() || from.size() != to.size())
+        return false;
+
+    auto blendable = [](const QImage &image){
+        return image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32_Premultiplied;
+    };
+
+    m_from = blendable(from) ? from : from.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    m_to   = blendable(to) ? to : to.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    const QImage::Format format = m_to.format();
+
+    for (auto &frame : m_frames)
+    {
+        if (frame.size() != m_from.size() || frame.format() != format)
+            frame = QImage(m_from.size(), format);
+        frame.setDevicePixelRatio(to.devicePixelRatio());
+    }
+
+    m_statistics.transitions++;
+    m_lastFrame = 0;
+    m_clock.start();
+
+    // 第一帧在第一个节拍到来前就开始渲染
+    render(qreal(1000 / m_frameRate) / m_duration);
+    m_timer.start(1000 / m_frameRate);
+
+    return true;
+}
+
+void TransitionEngine::stop()
+{
+    m_timer.stop();
+    m_render.waitForFinished();
+    m_hasPending = false;
+    m_from = QImage();
+    m_to   = QImage();
+}
+
+void TransitionEngine::onTick()
+{
+    const qint64 interval = m_timer.interval();
+    const qint64 elapsed  = m_clock.elapsed();
+    const qint64 frame    = elapsed / interval;
+
+    if (elapsed >= m_duration)
+    {
+        QImage to = m_to;
+        stop();
+        m_statistics.framesPresented++;
+        emit finished(to);
+        return;
+    }
+
+    // 后台帧未能在本节拍前完成，本帧丢弃，保持上一帧显示
+    if (!m_render.isFinished())
+    {
+        m_statistics.framesDropped++;
+        return;
+    }
+
+    // 定时器被界面线程阻塞时跳过的节拍同样计为丢帧
+    if (frame > m_lastFrame + 1)
+        m_statistics.framesDropped += int(frame - m_lastFrame - 1);
+    m_lastFrame = frame;
+
+    if (m_hasPending)
+    {
+        const int front = m_backIndex;
+        m_backIndex = 1 - m_backIndex;
+        m_statistics.framesPresented++;
+        emit frameReady(m_frames[front]);
+    }
+
+    // 按下一个节拍的时间点计算进度，渲染完成时正好用于呈现
+    render(qMin<qreal>(1.0, qreal((frame + 1) * interval) / m_duration));
+}
+
+void TransitionEngine::render(qreal progress)
+{
+    // 在界面线程中取得可写指针，界面仍持有上一轮的帧时在这里分离，工作线程不会改写正在显示的图片
+    uchar *out = m_frames[m_backIndex].bits();
+    const Effect effect = m_effect;
+    const int threads = qMax(1, QThread::idealThreadCount() - 1);
+    const int rows = m_frames[m_backIndex].height();
+
+    m_hasPending = true;
+    m_render = QtConcurrent::run([=](){
+        QVector<Band> bands;
+        for (int i = 0; i < threads; ++i)
+            bands.append({ rows * i / threads, rows * (i + 1) / threads });
+
+        QtConcurrent::blockingMap(bands, [=](const Band &band){
+            renderBand(out, effect, progress, band.begin, band.end);
+        });
+    });
+}
+
+void TransitionEngine::renderBand(uchar *out, Effect effect, qreal progress, int begin, int end) const
+{
+    // 所有图片尺寸和格式一致，直接按行操作裸指针
+    const int width  = m_from.width();
+    const int stride = m_from.bytesPerLine();
+    const uchar *from = m_from.constBits();
+    const uchar *to   = m_to.constBits();
+
+    const int alpha  = qRound(progress * 256);
+    const int offset = qBound(0, qRound(smoothStep(progress) * width), width);
+
+    for (int y = begin; y < end; ++y)
+    {
+        const quint32 *a = reinterpret_cast<const quint32*>(from + y * stride);
+        const quint32 *b = reinterpret_cast<const quint32*>(to + y * stride);
+        quint32 *dst     = reinterpret_cast<quint32*>(out + y * stride);
+
+        switch (effect)
+        {
+        case CrossFade:
+            PixelKernels::blend(a, b, dst, width, alpha);
+            break;
+        case Slide:
+            memcpy(dst, a + offset, size_t(width - offset) * 4);
+            memcpy(dst + width - offset, b, size_t(offset) * 4);
+            break;
+        case Wipe:
+            memcpy(dst, b, size_t(offset) * 4);
+            memcpy(dst + offset, a + offset, size_t(width - offset) * 4);
+            break;
+        default:
+            memcpy(dst, b, size_t(width) * 4);
+            break;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef TRANSITIONENGINE_H
+#define TRANSITIONENGINE_H
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QImage>
+#include <QObject>
+#include <QTimer>
+
+// 轮播切换特效：在工作线程中混合两张屏幕尺寸的图片，界面线程按固定节拍呈现已完成的帧
+class TransitionEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Effect
+    {
+        NoEffect = 0,                           // 直接切换
+        CrossFade,                              // 淡入淡出
+        Slide,                                  // 从右向左滑入
+        Wipe                                    // 从左向右擦除
+    };
+
+    struct Statistics
+    {
+        int transitions;
+        int framesPresented;
+        int framesDropped;
+    };
+
+    explicit TransitionEngine(QObject *parent = nullptr);
+    ~TransitionEngine();
+
+    void setEffect(Effect effect);
+    Effect effect() const;
+
+    void setDuration(int msec);
+    int duration() const;
+
+    void setFrameRate(int fps);
+    int frameRate() const;
+
+    bool isRunning() const;
+    Statistics statistics() const;
+
+    bool start(const QImage &from, const QImage &to);
+    void stop();
+
+signals:
+    void frameReady(const QImage &frame);
+    void finished(const QImage &to);
+
+private slots:
+    void onTick();
+
+private:
+    void render(qreal progress);
+    void renderBand(uchar *out, Effect effect, qreal progress, int begin, int end) const;
+
+private:
+    Effect m_effect = CrossFade;
+    int m_duration = 800;
+    int m_frameRate = 60;
+
+    QImage m_from;
+    QImage m_to;
+    QImage m_frames[2];                         // 前台帧供界面显示，后台帧由工作线程渲染
+    int m_backIndex = 0;
+    QFuture<void> m_render;
+    bool m_hasPending = false;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastFrame = 0;                     // 最近一次呈现的帧序号
+
+    Statistics m_statistics = { 0, 0, 0 };
+};
+
+#endif // TRANSITIONENGINE_H
@@ -0,0 +1,112 @@
+#include "visibilitymonitor.h"
+
+#if defined(Q_OS_WIN)
+#  include "win32visibilitybackend.h"
+#elif defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+#  include "x11visibilitybackend.h"
+#endif
+
+VisibilityBackend::VisibilityBackend(QObject *parent) : QObject(parent)
+{ }
+
+VisibilityBackend::~VisibilityBackend()
+{ }
+
+MockVisibilityBackend::MockVisibilityBackend(QObject *parent) : VisibilityBackend(parent)
+{ }
+
+VisibilityBackend::State MockVisibilityBackend::state()
+{
+    return m_state;
+}
+
+void MockVisibilityBackend::setState(State state)
+{
+    m_state = state;
+    emit changed();
+}
+
+VisibilityMonitor::VisibilityMonitor(QObject *parent) : QObject(parent)
+{
+    // 轮询作为兜底，后端能感知的变化（前台窗口切换、锁屏）会立即触发查询
+    m_timer.setInterval(250);
+
+    connect(&m_timer, &QTimer::timeout, this, &VisibilityMonitor::update);
+
+    setBackend(createDefaultBackend(this));
+}
+
+VisibilityMonitor::~VisibilityMonitor()
+{ }
+
+VisibilityBackend *VisibilityMonitor::createDefaultBackend(QObject *parent)
+{
+#if defined(Q_OS_WIN)
+    return new Win32VisibilityBackend(parent);
+#elif defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+    return new X11VisibilityBackend(parent);
+#else
+    return new MockVisibilityBackend(parent);
+#endif
+}
+
+void VisibilityMonitor::setBackend(VisibilityBackend *backend)
+{
+    if (m_pBackend != nullptr && m_pBackend->parent() == this)
+        delete m_pBackend;
+
+    m_pBackend = backend;
+
+    if (m_pBackend == nullptr)
+    {
+        m_timer.stop();
+        return;
+    }
+
+    connect(m_pBackend, &VisibilityBackend::changed, this, &VisibilityMonitor::update);
+    m_timer.start();
+    update();
+}
+
+VisibilityBackend *VisibilityMonitor::backend() const
+{
+    return m_pBackend;
+}
+
+void VisibilityMonitor::setInterval(int msec)
+{
+    m_timer.setInterval(qMax(10, msec));
+}
+
+int VisibilityMonitor::interval() const
+{
+    return m_timer.interval();
+}
+
+VisibilityBackend::State VisibilityMonitor::state() const
+{
+    return m_state;
+}
+
+bool VisibilityMonitor::isVisible() const
+{
+    return m_state == VisibilityBackend::Visible;
+}
+
+void VisibilityMonitor::update()
+{
+    if (m_pBackend == nullptr)
+        return;
+
+    const VisibilityBackend::State state = m_pBackend->state();
+    if (state == m_state)
+        return;
+
+    const bool wasVisible = isVisible();
+    m_state = state;
+
+    emit stateChanged(m_state);
+
+    if (wasVisible != isVisible())
+        emit visibilityChanged(isVisible());
+}
@@ -0,0 +1,77 @@
+#ifndef VISIBILITYMONITOR_H
+#define VISIBILITYMONITOR_H
+
+#include <QObject>
+#include <QTimer>
+
+// 平台相关的可见性查询接口，能够感知变化的后端通过 changed() 通知立即重新查询
+class VisibilityBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State
+    {
+        Visible = 0,                            // 桌面至少有一部分可见
+        Occluded,                               // 桌面被最大化或全屏窗口完全遮挡
+        Locked                                  // 会话已锁定或屏幕保护程序正在运行
+    };
+
+    explicit VisibilityBackend(QObject *parent = nullptr);
+    ~VisibilityBackend();
+
+    virtual State state() = 0;
+
+signals:
+    void changed();
+};
+
+// 手动设置状态的后端，用于调试和测试
+class MockVisibilityBackend : public VisibilityBackend
+{
+    Q_OBJECT
+
+public:
+    explicit MockVisibilityBackend(QObject *parent = nullptr);
+
+    State state() override;
+    void setState(State state);
+
+private:
+    State m_state = Visible;
+};
+
+// 壁纸可见性监视：被完全遮挡或锁屏时通知暂停动画、视频解码和预取，重新可见时立即恢复
+class VisibilityMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VisibilityMonitor(QObject *parent = nullptr);
+    ~VisibilityMonitor();
+
+    static VisibilityBackend *createDefaultBackend(QObject *parent = nullptr);
+
+    void setBackend(VisibilityBackend *backend);
+    VisibilityBackend *backend() const;
+
+    void setInterval(int msec);
+    int interval() const;
+
+    VisibilityBackend::State state() const;
+    bool isVisible() const;
+
+signals:
+    void stateChanged(VisibilityBackend::State state);
+    void visibilityChanged(bool visible);
+
+public slots:
+    void update();
+
+private:
+    VisibilityBackend *m_pBackend = nullptr;
+    QTimer m_timer;
+    VisibilityBackend::State m_state = VisibilityBackend::Visible;
+};
+
+#endif // VISIBILITYMONITOR_H
@@ -1,6 +1,6 @@
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 CONFIG += c++11
 
@@ -16,15 +16,80 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    animationdecoder.cpp \
+    animationplayer.cpp \
+    animationsource.cpp \
+    apngsource.cpp \
     characterlabel.cpp \
+    contenthash.cpp \
+    folderindexer.cpp \
+    framequeue.cpp \
+    framestore.cpp \
+    imagedecoder.cpp \
+    imageresampler.cpp \
+    imageslideshow.cpp \
+    jitterhistogram.cpp \
+    kenburnsanimator.cpp \
     main.cpp \
     mainwindow.cpp \
-    taskbarcontrol.cpp
+    mediaregistry.cpp \
+    memorybudget.cpp \
+    palettecodec.cpp \
+    pixelkernels.cpp \
+    playlist.cpp \
+    powerprofile.cpp \
+    powersource.cpp \
+    resolutionvariants.cpp \
+    slideshowscheduler.cpp \
+    taskbarcontrol.cpp \
+    transitionengine.cpp \
+    visibilitymonitor.cpp \
+    wallpapercache.cpp \
+    wallpapersurface.cpp
 
 HEADERS += \
+    animationdecoder.h \
+    animationplayer.h \
+    animationsource.h \
+    apngsource.h \
     characterlabel.h \
+    contenthash.h \
+    folderindexer.h \
+    framequeue.h \
+    framestore.h \
+    imagedecoder.h \
+    imageresampler.h \
+    imageslideshow.h \
+    jitterhistogram.h \
+    kenburnsanimator.h \
     mainwindow.h \
-    taskbarcontrol.h
+    mediaregistry.h \
+    memorybudget.h \
+    palettecodec.h \
+    pixelkernels.h \
+    playlist.h \
+    powerprofile.h \
+    powersource.h \
+    resolutionvariants.h \
+    slideshowscheduler.h \
+    taskbarcontrol.h \
+    transitionengine.h \
+    visibilitymonitor.h \
+    wallpapercache.h \
+    wallpapersurface.h
+
+# 壁纸可见性检测的平台实现
+win32 {
+    SOURCES += win32visibilitybackend.cpp
+    HEADERS += win32visibilitybackend.h
+    LIBS += -ldwmapi -lwtsapi32
+}
+
+unix:!macx {
+    SOURCES += x11visibilitybackend.cpp
+    HEADERS += x11visibilitybackend.h
+    LIBS += -lX11 -lXss
+}
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,462 @@
+#include "wallpapercache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+
+namespace
+{
+// 缓存文件头，像素数据紧随其后并按 64 字节对齐
+struct CacheHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 format;
+    double devicePixelRatio;
+    quint8 reserved[32];
+};
+
+static_assert(sizeof(CacheHeader) == 64, "CacheHeader must stay 64 bytes");
+
+const char CacheMagic[4] = { 'S', 'W', 'P', 'C' };
+const quint32 CacheVersion = 1;
+
+// 内容哈希索引文件，与缓存条目放在同一目录，不参与缓存大小统计和淘汰
+const quint32 IndexMagic = 0x53575048;          // "SWPH"
+const quint32 IndexVersion = 1;
+
+void unmapCacheFile(void *info)
+{
+    delete static_cast<QFile*>(info);
+}
+}
+
+WallpaperCache *WallpaperCache::instance()
+{
+    static WallpaperCache cache;
+    return &cache;
+}
+
+WallpaperCache::WallpaperCache()
+    : m_dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/wallpaper"))
+{
+    MemoryBudget::instance()->registerConsumer(this);
+}
+
+WallpaperCache::~WallpaperCache()
+{
+    MemoryBudget::instance()->unregisterConsumer(this);
+}
+
+void WallpaperCache::setDirectory(const QString &dir)
+{
+    saveHashes();
+
+    QMutexLocker locker(&m_mutex);
+
+    // 已知的内容哈希与缓存目录无关，新目录中的索引在下次查询时合并进来
+    m_dir  = dir;
+    m_size = -1;
+    m_hashesLoaded = false;
+}
+
+QString WallpaperCache::directory() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_dir;
+}
+
+void WallpaperCache::setLimit(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_limit = qMax<qint64>(0, bytes);
+    evict();
+}
+
+qint64 WallpaperCache::limit() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_limit;
+}
+
+bool WallpaperCache::knownHash(const QString &path, quint64 *hash)
+{
+    QFileInfo info(path);
+    const QString key = info.absoluteFilePath();
+
+    QMutexLocker locker(&m_mutex);
+
+    loadHashes();
+
+    auto it = m_hashes.constFind(key);
+    if (it == m_hashes.constEnd() || it->modified != info.lastModified().toMSecsSinceEpoch() || it->size != info.size())
+        return false;
+
+    *hash = it->hash;
+    return true;
+}
+
+void WallpaperCache::rememberHash(const QString &path, quint64 hash)
+{
+    QFileInfo info(path);
+    const FileHash entry = { info.lastModified().toMSecsSinceEpoch(), info.size(), hash };
+    QHash<QString, FileHash> hashes;
+    QString index;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        loadHashes();
+        m_hashes.insert(info.absoluteFilePath(), entry);
+
+        // 新增的条目积累到索引的一定比例后写回，新文件很多时写入次数不随文件数线性增长
+        if (++m_unsavedHashes < qMax(64, m_hashes.count() / 16))
+            return;
+
+        hashes = m_hashes;
+        index  = indexPath();
+        m_unsavedHashes = 0;
+    }
+
+    // 在锁外写入索引的快照，不阻塞其他线程的查询
+    writeHashes(index, hashes);
+}
+
+void WallpaperCache::saveHashes()
+{
+    QHash<QString, FileHash> hashes;
+    QString index;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (m_unsavedHashes == 0)
+            return;
+
+        hashes = m_hashes;
+        index  = indexPath();
+        m_unsavedHashes = 0;
+    }
+
+    writeHashes(index, hashes);
+}
+
+QImage WallpaperCache::lookup(const QString &path, quint64 hash, const QSize &targetSize)
+{
+    const QString name = entryName(hash, targetSize);
+
+    // 内容相同的图片已经解码并仍在使用时直接共用
+    {
+        QMutexLocker locker(&m_mutex);
+
+        pruneShared();
+
+        // 同一个文件再次查询（例如淘汰后重新解码）只是复用，不算内容去重
+        auto it = m_shared.constFind(name);
+        if (it != m_shared.constEnd())
+        {
+            m_hits.ref();
+            if (it->path != path)
+                m_dedupHits.ref();
+            return it->image;
+        }
+    }
+
+    QString entry = directory() + QLatin1Char('/') + name;
+    QFile *file = new QFile(entry);
+
+    // 映射只读打开，图片数据不可能写回缓存文件
+    if (!file->open(QIODevice::ReadOnly))
+    {
+        delete file;
+        m_misses.ref();
+        return QImage();
+    }
+
+    const qint64 fileSize = file->size();
+    const uchar *data = fileSize >= qint64(sizeof(CacheHeader)) ? file->map(0, fileSize) : nullptr;
+    const CacheHeader *header = reinterpret_cast<const CacheHeader*>(data);
+
+    if (header == nullptr
+            || memcmp(header->magic, CacheMagic, sizeof(CacheMagic)) != 0
+            || header->version != CacheVersion
+            || header->format >= QImage::NImageFormats
+            || fileSize < qint64(sizeof(CacheHeader)) + qint64(header->bytesPerLine) * header->height)
+    {
+        delete file;
+        QFile::remove(entry);
+        m_misses.ref();
+        return QImage();
+    }
+
+    // 修改时间作为 LRU 时钟，通过另一个可写句柄更新，只读目录下更新失败不影响使用
+    QFile touch(entry);
+    if (touch.open(QIODevice::ReadWrite))
+        touch.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    // 图片以常量数据构造并引用映射内存，任何修改都会先深拷贝
+    QImage image(static_cast<const uchar*>(data + sizeof(CacheHeader)), int(header->width), int(header->height), int(header->bytesPerLine),
+                 QImage::Format(header->format), unmapCacheFile, file);
+    image.setDevicePixelRatio(header->devicePixelRatio);
+
+    m_hits.ref();
+
+    QMutexLocker locker(&m_mutex);
+
+    // 其他线程可能同时映射了同一条目，以先登记的为准
+    auto it = m_shared.constFind(name);
+    if (it != m_shared.constEnd())
+        return it->image;
+
+    m_shared.insert(name, { image, path });
+    return image;
+}
+
+QImage WallpaperCache::store(const QString &path, quint64 hash, const QSize &targetSize, const QImage &image)
+{
+    if (image.isNull())
+        return image;
+
+    const QString name = entryName(hash, targetSize);
+    const qint64 entrySize = qint64(sizeof(CacheHeader)) + qint64(image.bytesPerLine()) * image.height();
+    QString entry;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        // 内容相同的文件同时解码时只保留先完成的一份
+        pruneShared();
+
+        auto it = m_shared.constFind(name);
+        if (it != m_shared.constEnd())
+            return it->image;
+
+        m_shared.insert(name, { image, path });
+
+        if (entrySize > m_limit)
+            return image;
+
+        QDir().mkpath(m_dir);
+        entry = m_dir + QLatin1Char('/') + name;
+    }
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version          = CacheVersion;
+    header.width            = quint32(image.width());
+    header.height           = quint32(image.height());
+    header.bytesPerLine     = quint32(image.bytesPerLine());
+    header.format           = quint32(image.format());
+    header.devicePixelRatio = image.devicePixelRatio();
+
+    QSaveFile file(entry);
+    if (!file.open(QIODevice::WriteOnly))
+        return image;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(image.constBits()), qint64(image.bytesPerLine()) * image.height());
+
+    if (!file.commit())
+        return image;
+
+    m_stores.ref();
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_size < 0)
+        scan();
+    else
+        m_size += entrySize;
+
+    evict();
+
+    return image;
+}
+
+void WallpaperCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QDir dir(m_dir);
+    for (auto name : dir.entryList({ QStringLiteral("*.raw") }, QDir::Files))
+        dir.remove(name);
+
+    m_size = 0;
+    m_shared.clear();
+}
+
+QString WallpaperCache::memoryName() const
+{
+    return QStringLiteral("shared");
+}
+
+qint64 WallpaperCache::memoryUsage() const
+{
+    // 仍在显示或预取的图片由使用者登记，这里只计入已无人使用、只在共用表中等待清理的图片
+    QMutexLocker locker(&m_mutex);
+
+    qint64 total = 0;
+    for (auto &shared : m_shared)
+        if (shared.image.isDetached())
+            total += shared.image.sizeInBytes();
+
+    return total;
+}
+
+int WallpaperCache::memoryPriority() const
+{
+    return CachePriority;
+}
+
+qint64 WallpaperCache::releaseMemory(qint64 bytes)
+{
+    Q_UNUSED(bytes)
+
+    QMutexLocker locker(&m_mutex);
+
+    return pruneShared();
+}
+
+WallpaperCache::Statistics WallpaperCache::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    const int lookups = m_hits.load() + m_misses.load();
+    const double dedupRate = lookups > 0 ? double(m_dedupHits.load()) / lookups : 0.0;
+
+    return { m_hits.load(), m_misses.load(), m_stores.load(), m_evictions.load(), m_dedupHits.load(), dedupRate,
+             qMax<qint64>(0, m_size), m_limit };
+}
+
+QString WallpaperCache::entryName(quint64 hash, const QSize &targetSize)
+{
+    return QStringLiteral("%1_%2x%3.raw").arg(hash, 16, 16, QLatin1Char('0')).arg(targetSize.width()).arg(targetSize.height());
+}
+
+QString WallpaperCache::indexPath() const
+{
+    return m_dir + QStringLiteral("/hashes.idx");
+}
+
+void WallpaperCache::loadHashes()
+{
+    if (m_hashesLoaded)
+        return;
+
+    m_hashesLoaded = true;
+
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+
+    if (magic != IndexMagic || version != IndexVersion)
+        return;
+
+    // 内存中已有的条目比文件中的新，保留内存中的；文件被截断时保留已读出的部分
+    for (quint32 i = 0; i < count; ++i)
+    {
+        QString path;
+        FileHash entry;
+        stream >> path >> entry.modified >> entry.size >> entry.hash;
+
+        if (stream.status() != QDataStream::Ok)
+            break;
+
+        if (!m_hashes.contains(path))
+            m_hashes.insert(path, entry);
+    }
+}
+
+void WallpaperCache::writeHashes(const QString &path, const QHash<QString, FileHash> &hashes)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << IndexMagic << IndexVersion << quint32(hashes.count());
+
+    for (auto it = hashes.constBegin(); it != hashes.constEnd(); ++it)
+        stream << it.key() << it->modified << it->size << it->hash;
+
+    file.commit();
+}
+
+qint64 WallpaperCache::pruneShared()
+{
+    // 引用计数只剩表内一份时说明图片已不再显示或预取
+    qint64 released = 0;
+
+    for (auto it = m_shared.begin(); it != m_shared.end();)
+    {
+        if (it->image.isDetached())
+        {
+            released += it->image.sizeInBytes();
+            it = m_shared.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    return released;
+}
+
+void WallpaperCache::scan()
+{
+    m_size = 0;
+
+    for (auto info : QDir(m_dir).entryInfoList({ QStringLiteral("*.raw") }, QDir::Files))
+        m_size += info.size();
+}
+
+void WallpaperCache::evict()
+{
+    if (m_size < 0)
+        scan();
+
+    if (m_size <= m_limit)
+        return;
+
+    // 最久未使用的文件排在最前，一次淘汰到上限的 90% 以免频繁扫描目录
+    QDir dir(m_dir);
+    const qint64 target = m_limit / 10 * 9;
+
+    for (auto info : dir.entryInfoList({ QStringLiteral("*.raw") }, QDir::Files, QDir::Time | QDir::Reversed))
+    {
+        if (m_size <= target)
+            break;
+
+        if (dir.remove(info.fileName()))
+        {
+            m_size -= info.size();
+            m_evictions.ref();
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef WALLPAPERCACHE_H
+#define WALLPAPERCACHE_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+#include "memorybudget.h"
+
+// 磁盘缓存：保存已缩放到屏幕尺寸、已转换格式的像素数据，下次启动直接内存映射显示，无需解码
+// 条目按文件内容哈希索引，内容相同的文件共用同一份缓存和同一块已解码的内存
+class WallpaperCache : public MemoryConsumer
+{
+public:
+    struct Statistics
+    {
+        int hits;
+        int misses;
+        int stores;
+        int evictions;
+        int dedupHits;                          // 不同路径的相同内容直接共用内存中已解码图片的次数
+        double dedupRate;                       // 占全部查询的比例
+        qint64 size;
+        qint64 limit;
+    };
+
+    static WallpaperCache *instance();
+
+    void setDirectory(const QString &dir);
+    QString directory() const;
+
+    void setLimit(qint64 bytes);
+    qint64 limit() const;
+
+    bool knownHash(const QString &path, quint64 *hash);
+    void rememberHash(const QString &path, quint64 hash);
+    void saveHashes();
+
+    QImage lookup(const QString &path, quint64 hash, const QSize &targetSize);
+    QImage store(const QString &path, quint64 hash, const QSize &targetSize, const QImage &image);
+    void clear();
+
+    Statistics statistics() const;
+
+    QString memoryName() const override;
+    qint64 memoryUsage() const override;
+    int memoryPriority() const override;
+    qint64 releaseMemory(qint64 bytes) override;
+
+private:
+    struct FileHash
+    {
+        qint64 modified;
+        qint64 size;
+        quint64 hash;
+    };
+
+    struct SharedImage
+    {
+        QImage image;
+        QString path;                           // 最先存入这份图片的文件，其他路径查到它才算内容去重
+    };
+
+    WallpaperCache();
+    ~WallpaperCache();
+
+    static QString entryName(quint64 hash, const QSize &targetSize);
+    QString indexPath() const;
+    void loadHashes();
+    static void writeHashes(const QString &path, const QHash<QString, FileHash> &hashes);
+    qint64 pruneShared();
+    void scan();
+    void evict();
+
+private:
+    mutable QMutex m_mutex;
+    QString m_dir;
+    qint64 m_size = -1;                         // -1 表示尚未统计缓存目录
+    qint64 m_limit = 512 * 1024 * 1024;
+    QHash<QString, FileHash> m_hashes;          // 绝对路径 -> 修改时间、大小和内容哈希，保存在缓存目录中，重启后同样不必读取整个文件
+    bool m_hashesLoaded = false;
+    int m_unsavedHashes = 0;
+    QHash<QString, SharedImage> m_shared;       // 仍被使用的已解码图片，只剩此处引用时移除
+
+    QAtomicInt m_hits;
+    QAtomicInt m_misses;
+    QAtomicInt m_stores;
+    QAtomicInt m_evictions;
+    QAtomicInt m_dedupHits;
+};
+
+#endif // WALLPAPERCACHE_H
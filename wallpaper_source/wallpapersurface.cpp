@@ -0,0 +1,221 @@
+#include "wallpapersurface.h"
+
+#include <QPaintEvent>
+#include <QPainter>
+
+#include <cmath>
+#include <cstring>
+
+WallpaperSurface::WallpaperSurface(QWidget *parent) : QWidget(parent)
+{
+    // 缓冲总是覆盖整个窗口，不需要 Qt 预先擦除背景
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setAttribute(Qt::WA_NoSystemBackground);
+    setAutoFillBackground(false);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setTimerType(Qt::PreciseTimer);
+
+    connect(&m_flushTimer, &QTimer::timeout, this, &WallpaperSurface::flushPending);
+}
+
+WallpaperSurface::~WallpaperSurface()
+{ }
+
+void WallpaperSurface::setBufferSize(const QSize &size, qreal devicePixelRatio)
+{
+    if (m_buffer.size() == size && qFuzzyCompare(m_buffer.devicePixelRatio(), devicePixelRatio))
+        return;
+
+    m_buffer = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    m_buffer.setDevicePixelRatio(devicePixelRatio);
+    m_buffer.fill(Qt::black);
+
+    update();
+}
+
+QSize WallpaperSurface::bufferSize() const
+{
+    return m_buffer.size();
+}
+
+QImage WallpaperSurface::buffer() const
+{
+    return m_buffer;
+}
+
+void WallpaperSurface::setUpdateRateLimit(int fps)
+{
+    m_updateRateLimit = qMax(0, fps);
+
+    if (m_updateRateLimit == 0)
+        flushPending();
+}
+
+int WallpaperSurface::updateRateLimit() const
+{
+    return m_updateRateLimit;
+}
+
+void WallpaperSurface::setImage(const QImage &image)
+{
+    if (image.isNull())
+        return;
+
+    // 整幅替换，尚未呈现的局部更新作废
+    m_flushTimer.stop();
+    m_pendingImage = QImage();
+    m_pendingRect  = QRect();
+    m_pendingDirty = QRect();
+
+    if (m_buffer.isNull())
+        setBufferSize(image.size(), image.devicePixelRatio());
+
+    update(toLogical(copyRegion(image, image.rect())));
+}
+
+void WallpaperSurface::updateRegion(const QImage &image, const QRect &rect)
+{
+    if (image.isNull() || rect.isEmpty())
+        return;
+
+    if (m_buffer.isNull())
+        setBufferSize(image.size(), image.devicePixelRatio());
+
+    m_pendingImage = image;
+    m_pendingRect |= rect;
+
+    scheduleFlush();
+}
+
+void WallpaperSurface::blit(const QImage &patch, const QPoint &position)
+{
+    if (patch.isNull() || m_buffer.isNull())
+        return;
+
+    // 尺寸已与缓冲一致的变化区域立即拷贝，重绘仍受帧率上限约束
+    m_pendingDirty |= copyPatch(patch, position);
+
+    scheduleFlush();
+}
+
+void WallpaperSurface::scheduleFlush()
+{
+    if (m_updateRateLimit > 0 && m_lastUpdate.isValid())
+    {
+        const qint64 wait = 1000 / m_updateRateLimit - m_lastUpdate.elapsed();
+        if (wait > 0)
+        {
+            if (!m_flushTimer.isActive())
+                m_flushTimer.start(int(wait));
+            return;
+        }
+    }
+
+    flushPending();
+}
+
+void WallpaperSurface::flushPending()
+{
+    m_flushTimer.stop();
+
+    QRect dirty = m_pendingDirty;
+    if (!m_pendingImage.isNull())
+        dirty |= copyRegion(m_pendingImage, m_pendingRect);
+
+    if (dirty.isEmpty())
+        return;
+
+    update(toLogical(dirty));
+
+    m_pendingImage = QImage();
+    m_pendingRect  = QRect();
+    m_pendingDirty = QRect();
+    m_lastUpdate.start();
+}
+
+void WallpaperSurface::fill(const QColor &color)
+{
+    m_buffer.fill(color);
+    update();
+}
+
+void WallpaperSurface::paintEvent(QPaintEvent *event)
+{
+    if (m_buffer.isNull())
+        return;
+
+    // 逐个绘制脏矩形，源格式与窗口后备存储一致时绘制即为逐行拷贝
+    QPainter painter(this);
+    const qreal ratio = m_buffer.devicePixelRatio();
+
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+    for (const QRect &rect : event->region())
+    {
+        QRectF source(rect.x() * ratio, rect.y() * ratio, rect.width() * ratio, rect.height() * ratio);
+        painter.drawImage(QRectF(rect), m_buffer, source);
+    }
+}
+
+QRect WallpaperSurface::copyRegion(const QImage &image, const QRect &rect)
+{
+    // 尺寸与缓冲一致时逐行拷贝；RGB32 的像素不透明，与预乘格式内存布局相同
+    if (image.size() == m_buffer.size())
+    {
+        const QRect dirty = rect & m_buffer.rect();
+        const bool direct = image.format() == QImage::Format_ARGB32_Premultiplied || image.format() == QImage::Format_RGB32;
+        const QImage source = direct ? image : image.copy(dirty).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        const QPoint origin = direct ? dirty.topLeft() : QPoint(0, 0);
+        const size_t bytes = size_t(dirty.width()) * 4;
+
+        for (int y = 0; y < dirty.height(); ++y)
+            memcpy(m_buffer.scanLine(dirty.top() + y) + dirty.left() * 4,
+                   source.constScanLine(origin.y() + y) + origin.x() * 4, bytes);
+
+        return dirty;
+    }
+
+    // 尺寸不同时只把变化区域缩放绘制到缓冲中对应的位置，画笔坐标为逻辑像素
+    const qreal ratio = m_buffer.devicePixelRatio();
+    const qreal sx = qreal(m_buffer.width()) / image.width();
+    const qreal sy = qreal(m_buffer.height()) / image.height();
+    const QRectF target(rect.x() * sx, rect.y() * sy, rect.width() * sx, rect.height() * sy);
+
+    QPainter painter(&m_buffer);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(QRectF(target.topLeft() / ratio, target.size() / ratio), image, rect);
+
+    return target.toAlignedRect() & m_buffer.rect();
+}
+
+QRect WallpaperSurface::copyPatch(const QImage &patch, const QPoint &position)
+{
+    const QRect dirty = QRect(position, patch.size()) & m_buffer.rect();
+    if (dirty.isEmpty())
+        return QRect();
+
+    const QImage source = patch.format() == QImage::Format_ARGB32_Premultiplied || patch.format() == QImage::Format_RGB32
+            ? patch : patch.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const QPoint origin = dirty.topLeft() - position;
+    const size_t bytes = size_t(dirty.width()) * 4;
+
+    for (int y = 0; y < dirty.height(); ++y)
+        memcpy(m_buffer.scanLine(dirty.top() + y) + dirty.left() * 4,
+               source.constScanLine(origin.y() + y) + origin.x() * 4, bytes);
+
+    return dirty;
+}
+
+QRect WallpaperSurface::toLogical(const QRect &rect) const
+{
+    const qreal ratio = m_buffer.devicePixelRatio();
+
+    if (qFuzzyCompare(ratio, 1.0))
+        return rect;
+
+    // 向外取整，保证分数缩放下脏区域完整覆盖
+    return QRect(QPoint(int(std::floor(rect.left() / ratio)), int(std::floor(rect.top() / ratio))),
+                 QPoint(int(std::ceil((rect.right() + 1) / ratio)) - 1, int(std::ceil((rect.bottom() + 1) / ratio)) - 1));
+}
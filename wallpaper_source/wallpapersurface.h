@@ -0,0 +1,54 @@
+#ifndef WALLPAPERSURFACE_H
+#define WALLPAPERSURFACE_H
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QRect>
+#include <QTimer>
+#include <QWidget>
+
+// 壁纸绘制窗口：持有一块预乘格式的屏幕大小缓冲，更新时只拷贝并重绘变化的区域
+class WallpaperSurface : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit WallpaperSurface(QWidget *parent = nullptr);
+    ~WallpaperSurface();
+
+    void setBufferSize(const QSize &size, qreal devicePixelRatio = 1.0);
+    QSize bufferSize() const;
+    QImage buffer() const;
+
+    void setUpdateRateLimit(int fps);
+    int updateRateLimit() const;
+
+public slots:
+    void setImage(const QImage &image);
+    void updateRegion(const QImage &image, const QRect &rect);
+    void blit(const QImage &patch, const QPoint &position);
+    void fill(const QColor &color);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QRect copyRegion(const QImage &image, const QRect &rect);
+    QRect copyPatch(const QImage &patch, const QPoint &position);
+    QRect toLogical(const QRect &rect) const;
+    void scheduleFlush();
+    void flushPending();
+
+private:
+    QImage m_buffer;                            // 物理像素，格式固定为 ARGB32_Premultiplied
+
+    // 局部更新的帧率上限：间隔内到达的更新合并脏区域，到期后从最新一帧拷贝
+    int m_updateRateLimit = 0;
+    QElapsedTimer m_lastUpdate;
+    QTimer m_flushTimer;
+    QImage m_pendingImage;
+    QRect m_pendingRect;
+    QRect m_pendingDirty;                       // 已拷贝到缓冲、尚未重绘的区域
+};
+
+#endif // WALLPAPERSURFACE_H
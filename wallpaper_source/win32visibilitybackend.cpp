@@ -0,0 +1,159 @@
+#include "win32visibilitybackend.h"
+
+#include <dwmapi.h>
+#include <wtsapi32.h>
+
+// 旧版 MinGW 头文件按 Windows 7 声明，没有该属性
+#ifndef DWMWA_CLOAKED
+#  define DWMWA_CLOAKED 14
+#endif
+
+namespace
+{
+struct EnumContext
+{
+    HMONITOR monitor;
+    RECT monitorRect;
+    bool occluded;
+};
+}
+
+Win32VisibilityBackend *Win32VisibilityBackend::s_pInstance = nullptr;
+
+Win32VisibilityBackend::Win32VisibilityBackend(QObject *parent) : VisibilityBackend(parent)
+{
+    // 事件钩子在界面线程的消息循环中回调，前台窗口切换和窗口最小化/还原时立即重新查询
+    s_pInstance = this;
+    m_hForegroundHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, NULL,
+                                        winEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    m_hMinimizeHook   = SetWinEventHook(EVENT_SYSTEM_MINIMIZESTART, EVENT_SYSTEM_MINIMIZEEND, NULL,
+                                        winEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+
+    // 锁屏状态由会话通知维护，轮询时只读取缓存的状态
+    WNDCLASSW windowClass = { 0 };
+    windowClass.lpfnWndProc   = sessionWindowProc;
+    windowClass.hInstance     = GetModuleHandle(NULL);
+    windowClass.lpszClassName = L"SimpleWallpaperSessionWindow";
+    RegisterClassW(&windowClass);
+
+    m_hSessionWindow = CreateWindowExW(0, windowClass.lpszClassName, L"", 0, 0, 0, 0, 0,
+                                       HWND_MESSAGE, NULL, windowClass.hInstance, NULL);
+    if (m_hSessionWindow != nullptr)
+        WTSRegisterSessionNotification(m_hSessionWindow, NOTIFY_FOR_THIS_SESSION);
+}
+
+Win32VisibilityBackend::~Win32VisibilityBackend()
+{
+    if (m_hForegroundHook != nullptr)
+        UnhookWinEvent(m_hForegroundHook);
+    if (m_hMinimizeHook != nullptr)
+        UnhookWinEvent(m_hMinimizeHook);
+    if (m_hSessionWindow != nullptr)
+    {
+        WTSUnRegisterSessionNotification(m_hSessionWindow);
+        DestroyWindow(m_hSessionWindow);
+    }
+
+    if (s_pInstance == this)
+        s_pInstance = nullptr;
+}
+
+VisibilityBackend::State Win32VisibilityBackend::state()
+{
+    if (isLocked())
+        return Locked;
+
+    return isOccluded() ? Occluded : Visible;
+}
+
+bool Win32VisibilityBackend::isLocked() const
+{
+    if (m_locked)
+        return true;
+
+    BOOL screenSaver = FALSE;
+    return SystemParametersInfo(SPI_GETSCREENSAVERRUNNING, 0, &screenSaver, 0) && screenSaver;
+}
+
+bool Win32VisibilityBackend::isOccluded()
+{
+    EnumContext context;
+    context.monitor  = MonitorFromWindow(GetShellWindow(), MONITOR_DEFAULTTOPRIMARY);
+    context.occluded = false;
+
+    MONITORINFO info;
+    info.cbSize = sizeof(info);
+    if (!GetMonitorInfo(context.monitor, &info))
+        return false;
+
+    context.monitorRect = info.rcMonitor;
+
+    EnumWindows(enumWindowProc, reinterpret_cast<LPARAM>(&context));
+
+    return context.occluded;
+}
+
+BOOL CALLBACK Win32VisibilityBackend::enumWindowProc(HWND hwnd, LPARAM lParam)
+{
+    EnumContext *context = reinterpret_cast<EnumContext*>(lParam);
+
+    if (!IsWindowVisible(hwnd) || IsIconic(hwnd))
+        return TRUE;
+
+    // 虚拟桌面上隐藏的窗口和 UWP 挂起的窗口处于 cloaked 状态，实际不可见
+    DWORD cloaked = 0;
+    if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked)
+        return TRUE;
+
+    // 桌面本身（包括壁纸窗口所在的 WorkerW）不算遮挡
+    wchar_t className[32] = { 0 };
+    GetClassName(hwnd, className, 32);
+    if (wcscmp(className, L"Progman") == 0 || wcscmp(className, L"WorkerW") == 0)
+        return TRUE;
+
+    if (MonitorFromWindow(hwnd, MONITOR_DEFAULTTONULL) != context->monitor)
+        return TRUE;
+
+    // 最大化窗口或覆盖整个显示器的无边框全屏窗口
+    RECT rect;
+    const bool maximized = IsZoomed(hwnd);
+    const bool fullscreen = GetWindowRect(hwnd, &rect)
+            && rect.left <= context->monitorRect.left && rect.top <= context->monitorRect.top
+            && rect.right >= context->monitorRect.right && rect.bottom >= context->monitorRect.bottom;
+
+    if (maximized || fullscreen)
+    {
+        context->occluded = true;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void CALLBACK Win32VisibilityBackend::winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject,
+                                                   LONG idChild, DWORD thread, DWORD time)
+{
+    Q_UNUSED(hook)
+    Q_UNUSED(event)
+    Q_UNUSED(hwnd)
+    Q_UNUSED(idObject)
+    Q_UNUSED(idChild)
+    Q_UNUSED(thread)
+    Q_UNUSED(time)
+
+    if (s_pInstance != nullptr)
+        emit s_pInstance->changed();
+}
+
+LRESULT CALLBACK Win32VisibilityBackend::sessionWindowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    if (message == WM_WTSSESSION_CHANGE && s_pInstance != nullptr
+            && (wParam == WTS_SESSION_LOCK || wParam == WTS_SESSION_UNLOCK))
+    {
+        s_pInstance->m_locked = wParam == WTS_SESSION_LOCK;
+        emit s_pInstance->changed();
+        return 0;
+    }
+
+    return DefWindowProc(hwnd, message, wParam, lParam);
+}
@@ -0,0 +1,35 @@
+#ifndef WIN32VISIBILITYBACKEND_H
+#define WIN32VISIBILITYBACKEND_H
+
+#include <qt_windows.h>
+
+#include "visibilitymonitor.h"
+
+// Windows 实现：收到会话锁定通知或屏幕保护程序运行时视为锁定，主屏幕上有最大化或全屏的可见窗口时视为遮挡
+class Win32VisibilityBackend : public VisibilityBackend
+{
+    Q_OBJECT
+
+public:
+    explicit Win32VisibilityBackend(QObject *parent = nullptr);
+    ~Win32VisibilityBackend();
+
+    State state() override;
+
+private:
+    bool isLocked() const;
+    static bool isOccluded();
+    static LRESULT CALLBACK sessionWindowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
+    static BOOL CALLBACK enumWindowProc(HWND hwnd, LPARAM lParam);
+    static void CALLBACK winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject,
+                                      LONG idChild, DWORD thread, DWORD time);
+
+private:
+    static Win32VisibilityBackend *s_pInstance;
+    HWINEVENTHOOK m_hForegroundHook = nullptr;
+    HWINEVENTHOOK m_hMinimizeHook   = nullptr;
+    HWND m_hSessionWindow = nullptr;            // 只接收会话锁定/解锁通知的消息窗口
+    bool m_locked = false;
+};
+
+#endif // WIN32VISIBILITYBACKEND_H
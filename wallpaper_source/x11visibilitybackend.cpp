@@ -0,0 +1,116 @@
+#include "x11visibilitybackend.h"
+
+#include <QVector>
+
+// Xlib 定义了 None、Bool 等宏，放在 Qt 头文件之后
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/scrnsaver.h>
+
+namespace
+{
+// 读取窗口的 32 位数组属性，失败时返回空
+QVector<unsigned long> windowProperty(Display *display, Window window, Atom property, Atom type)
+{
+    QVector<unsigned long> values;
+    Atom actualType = None;
+    int actualFormat = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char *data = nullptr;
+
+    if (XGetWindowProperty(display, window, property, 0, 1024, False, type, &actualType, &actualFormat,
+                           &count, &remaining, &data) != Success)
+        return values;
+
+    if (actualType == type && actualFormat == 32 && data != nullptr)
+    {
+        const unsigned long *items = reinterpret_cast<const unsigned long*>(data);
+        values = QVector<unsigned long>(items, items + count);
+    }
+
+    if (data != nullptr)
+        XFree(data);
+
+    return values;
+}
+}
+
+X11VisibilityBackend::X11VisibilityBackend(QObject *parent) : VisibilityBackend(parent)
+{
+    m_pDisplay = XOpenDisplay(nullptr);
+
+    int eventBase = 0;
+    int errorBase = 0;
+    m_hasScreenSaver = m_pDisplay != nullptr && XScreenSaverQueryExtension(m_pDisplay, &eventBase, &errorBase);
+}
+
+X11VisibilityBackend::~X11VisibilityBackend()
+{
+    if (m_pDisplay != nullptr)
+        XCloseDisplay(m_pDisplay);
+}
+
+VisibilityBackend::State X11VisibilityBackend::state()
+{
+    // 不是 X11 会话（例如 Wayland 且没有 XWayland）时始终视为可见
+    if (m_pDisplay == nullptr)
+        return Visible;
+
+    if (isLocked())
+        return Locked;
+
+    return isOccluded() ? Occluded : Visible;
+}
+
+bool X11VisibilityBackend::isLocked() const
+{
+    if (!m_hasScreenSaver)
+        return false;
+
+    XScreenSaverInfo *info = XScreenSaverAllocInfo();
+    if (info == nullptr)
+        return false;
+
+    const bool locked = XScreenSaverQueryInfo(m_pDisplay, DefaultRootWindow(m_pDisplay), info)
+            && info->state == ScreenSaverOn;
+    XFree(info);
+
+    return locked;
+}
+
+bool X11VisibilityBackend::isOccluded() const
+{
+    const Atom stacking   = XInternAtom(m_pDisplay, "_NET_CLIENT_LIST_STACKING", False);
+    const Atom wmState    = XInternAtom(m_pDisplay, "_NET_WM_STATE", False);
+    const Atom fullscreen = XInternAtom(m_pDisplay, "_NET_WM_STATE_FULLSCREEN", False);
+    const Atom maxVert    = XInternAtom(m_pDisplay, "_NET_WM_STATE_MAXIMIZED_VERT", False);
+    const Atom maxHorz    = XInternAtom(m_pDisplay, "_NET_WM_STATE_MAXIMIZED_HORZ", False);
+    const Atom hidden     = XInternAtom(m_pDisplay, "_NET_WM_STATE_HIDDEN", False);
+    const Atom wmDesktop  = XInternAtom(m_pDisplay, "_NET_WM_DESKTOP", False);
+    const Atom current    = XInternAtom(m_pDisplay, "_NET_CURRENT_DESKTOP", False);
+    const Window root     = DefaultRootWindow(m_pDisplay);
+
+    const QVector<unsigned long> currentDesktop = windowProperty(m_pDisplay, root, current, XA_CARDINAL);
+
+    // 窗口管理器维护的堆叠顺序，只检查当前工作区中可见的普通窗口
+    const QVector<unsigned long> windows = windowProperty(m_pDisplay, root, stacking, XA_WINDOW);
+
+    for (auto window : windows)
+    {
+        // 0xFFFFFFFF 表示窗口显示在所有工作区
+        const QVector<unsigned long> desktop = windowProperty(m_pDisplay, window, wmDesktop, XA_CARDINAL);
+        if (!desktop.isEmpty() && !currentDesktop.isEmpty()
+                && desktop.first() != 0xFFFFFFFF && desktop.first() != currentDesktop.first())
+            continue;
+
+        const QVector<unsigned long> states = windowProperty(m_pDisplay, window, wmState, XA_ATOM);
+        if (states.contains(hidden))
+            continue;
+
+        if (states.contains(fullscreen) || (states.contains(maxVert) && states.contains(maxHorz)))
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,28 @@
+#ifndef X11VISIBILITYBACKEND_H
+#define X11VISIBILITYBACKEND_H
+
+#include "visibilitymonitor.h"
+
+typedef struct _XDisplay Display;
+
+// X11 实现：屏幕保护程序运行时视为锁定，按堆叠顺序存在最大化或全屏且未隐藏的窗口时视为遮挡
+class X11VisibilityBackend : public VisibilityBackend
+{
+    Q_OBJECT
+
+public:
+    explicit X11VisibilityBackend(QObject *parent = nullptr);
+    ~X11VisibilityBackend();
+
+    State state() override;
+
+private:
+    bool isLocked() const;
+    bool isOccluded() const;
+
+private:
+    Display *m_pDisplay = nullptr;              // 独立连接，查询不经过 Qt 的事件队列
+    bool m_hasScreenSaver = false;
+};
+
+#endif // X11VISIBILITYBACKEND_H